@@ -0,0 +1,481 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#include "World.h"
+#include "Erosion.h"
+#include "ErosionJob.h"
+#include "Climate.h"
+#include "Civilization.h"
+#include "Parallel.h"
+#include "FalloffCache.h"
+#include "ShardedGenerator.h"
+
+// Headless runner: generation -> erosion -> climate -> civilization for every seed and size
+// given on the command line, reported as JSON. Progress logs go to stderr so stdout stays valid JSON.
+
+namespace
+{
+    struct BatchOptions
+    {
+        std::vector<int> seeds = {12345};
+        std::vector<std::pair<int, int>> sizes = {{300, 200}};
+        World::IslandMode islandMode = World::IslandMode::SINGLE;
+        int droplets = 0;
+        int years = 0;
+        int processes = 1;
+        ErosionSimulator::Engine erosionEngine = ErosionSimulator::Engine::DROPLETS;
+        int pipeIterations = -1; // -1 = the engine's default
+        int thermalSweeps = 0;
+        int multiresolutionFactor = 1;
+        double erosionTimeLimitMs = 0.0; // 0 = run every droplet
+        ErosionSimulator::Schedule erosionSchedule = ErosionSimulator::Schedule::TILED;
+        ErosionSimulator::DropletKernel dropletKernel = ErosionSimulator::DropletKernel::BATCHED;
+        bool quiet = false;
+        std::string outputPath;
+    };
+
+    // Minimal streaming JSON writer: tracks whether a separator is due at each nesting level
+    class JsonWriter
+    {
+    private:
+        std::ostream &out;
+        std::vector<bool> needsComma;
+        bool afterKey = false;
+
+        void separate()
+        {
+            if (afterKey)
+            {
+                afterKey = false;
+                return;
+            }
+            if (!needsComma.empty())
+            {
+                if (needsComma.back())
+                    out << ",";
+                needsComma.back() = true;
+                out << "\n"
+                    << std::string(needsComma.size() * 2, ' ');
+            }
+        }
+
+        void writeString(const std::string &text)
+        {
+            out << '"';
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                    out << '\\' << c;
+                else if ((unsigned char)c < 0x20)
+                    out << ' ';
+                else
+                    out << c;
+            }
+            out << '"';
+        }
+
+        void close(char bracket)
+        {
+            bool hadItems = needsComma.back();
+            needsComma.pop_back();
+            if (hadItems)
+                out << "\n"
+                    << std::string(needsComma.size() * 2, ' ');
+            out << bracket;
+        }
+
+    public:
+        explicit JsonWriter(std::ostream &out) : out(out) {}
+
+        void beginObject()
+        {
+            separate();
+            out << "{";
+            needsComma.push_back(false);
+        }
+        void endObject() { close('}'); }
+
+        void beginArray()
+        {
+            separate();
+            out << "[";
+            needsComma.push_back(false);
+        }
+        void endArray() { close(']'); }
+
+        void key(const std::string &name)
+        {
+            separate();
+            writeString(name);
+            out << ": ";
+            afterKey = true;
+        }
+
+        void value(const std::string &text)
+        {
+            separate();
+            writeString(text);
+        }
+        void value(const char *text) { value(std::string(text)); }
+        void value(long long number)
+        {
+            separate();
+            out << number;
+        }
+        void value(int number) { value((long long)number); }
+        void value(double number)
+        {
+            separate();
+            out << number;
+        }
+
+        template <typename T>
+        void field(const std::string &name, const T &fieldValue)
+        {
+            key(name);
+            value(fieldValue);
+        }
+    };
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename T>
+    bool parseList(const std::string &text, std::vector<T> &items, bool (*parseItem)(const std::string &, T &))
+    {
+        items.clear();
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            T parsed;
+            if (!parseItem(item, parsed))
+                return false;
+            items.push_back(parsed);
+        }
+        return !items.empty();
+    }
+
+    bool parseSeed(const std::string &text, int &seed)
+    {
+        char *end = nullptr;
+        long value = std::strtol(text.c_str(), &end, 10);
+        seed = (int)value;
+        return !text.empty() && *end == '\0';
+    }
+
+    bool parseSize(const std::string &text, std::pair<int, int> &size)
+    {
+        size_t separator = text.find('x');
+        if (separator == std::string::npos)
+            return false;
+        size.first = std::atoi(text.substr(0, separator).c_str());
+        size.second = std::atoi(text.substr(separator + 1).c_str());
+        return size.first >= 2 && size.second >= 2;
+    }
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --seeds A,B,...      world seeds (default 12345)\n"
+                  << "  --sizes WxH,...      world sizes (default 300x200)\n"
+                  << "  --archipelago        generate archipelagos instead of single islands\n"
+                  << "  --droplets N         erosion droplets per world (default 0 = no erosion)\n"
+                  << "  --pipe-erosion       use the grid-based pipe model instead of droplets\n"
+                  << "  --pipe-iterations N  pipe-model iterations (default 150)\n"
+                  << "  --multiresolution F  erode a copy shrunk by F first, then add detail (default 1 = off)\n"
+                  << "  --thermal N          thermal erosion sweeps after hydraulic erosion (default 0)\n"
+                  << "  --sequential-erosion  run droplets one by one (the reference) instead of in tiles\n"
+                  << "  --erosion-time-limit MS  stop droplet erosion after MS milliseconds (runs droplets in order)\n"
+                  << "  --droplet-kernel K   scalar (one droplet at a time) or batched (default)\n"
+                  << "  --years N            civilization years to simulate (default 0)\n"
+                  << "  --threads N          worker threads (default: one per core)\n"
+                  << "  --processes N        worker processes for generation (default 1)\n"
+                  << "  --falloff-cache DIR  persist island falloff fields in DIR\n"
+                  << "  --output FILE        write JSON to FILE instead of stdout\n"
+                  << "  --quiet              suppress progress logs" << std::endl;
+    }
+
+    void runPipeline(const BatchOptions &options, int seed, int width, int height, JsonWriter &json)
+    {
+        const auto runStart = std::chrono::steady_clock::now();
+        std::cout << "Running seed " << seed << " at " << width << "x" << height << std::endl;
+
+        // Generation
+        auto stageStart = std::chrono::steady_clock::now();
+        World world(width, height, 1, seed);
+        world.setIslandMode(options.islandMode);
+        ShardedGenerator::generate(world, options.processes);
+        const double generationMs = millisecondsSince(stageStart);
+
+        // Erosion, with the same tuning as the viewer's erosion key
+        stageStart = std::chrono::steady_clock::now();
+        const bool pipeErosion = options.erosionEngine == ErosionSimulator::Engine::PIPE;
+        int dropletsCompleted = pipeErosion ? 0 : options.droplets;
+        if (options.droplets > 0 || pipeErosion)
+        {
+            ErosionSimulator erosion;
+            erosion.setEngine(options.erosionEngine);
+            if (options.pipeIterations >= 0)
+                erosion.getPipeErosion().getParameters().iterations = options.pipeIterations;
+            erosion.getParameters().erosion = 0.5f;
+            erosion.getParameters().capacity = 8.0f;
+            erosion.getParameters().maxLifetime = 50;
+            erosion.setSchedule(options.erosionSchedule);
+            erosion.setDropletKernel(options.dropletKernel);
+            erosion.setMultiresolution(options.multiresolutionFactor);
+            if (options.erosionTimeLimitMs > 0.0 && !pipeErosion)
+            {
+                // A long job is preempted at the limit; its map stays usable
+                ErosionJob job(erosion, world, options.droplets);
+                job.step(options.erosionTimeLimitMs);
+                if (!job.isFinished())
+                {
+                    job.cancel();
+                    std::cout << "Erosion stopped at the time limit after " << job.getCompletedDroplets() << " of "
+                              << job.getTotalDroplets() << " droplets" << std::endl;
+                }
+                dropletsCompleted = job.getCompletedDroplets();
+            }
+            else
+            {
+                erosion.erode(world, options.droplets);
+            }
+        }
+        if (options.thermalSweeps > 0)
+        {
+            ErosionSimulator erosion;
+            erosion.getThermalErosion().getParameters().iterations = options.thermalSweeps;
+            erosion.erodeThermal(world);
+        }
+        const double erosionMs = millisecondsSince(stageStart);
+
+        // Climate
+        stageStart = std::chrono::steady_clock::now();
+        ClimateSystem climate(width, height);
+        climate.generateClimate(world);
+        const double climateMs = millisecondsSince(stageStart);
+
+        // Civilization
+        stageStart = std::chrono::steady_clock::now();
+        CivilizationSystem civilization(width, height);
+        civilization.initialize(world, climate);
+        for (int year = 0; year < options.years; year++)
+        {
+            civilization.simulate(world, climate);
+        }
+        const double civilizationMs = millisecondsSince(stageStart);
+
+        // Statistics over the final maps
+        ElevationStats elevationStats;
+        const Grid2D<float> &elevation = world.getElevationMap();
+        for (int y = 0; y < height; y++)
+        {
+            elevationStats.addRow(elevation.row(y), width, world.getLandThreshold());
+        }
+
+        const int biomeCount = (int)BiomeType::RIVER + 1;
+        std::vector<long long> biomeHistogram(biomeCount, 0);
+        const Grid2D<BiomeType> &biomes = climate.getBiomeMap();
+        for (size_t i = 0; i < biomes.size(); i++)
+        {
+            biomeHistogram[(int)biomes[i]]++;
+        }
+
+        const City *largestCity = nullptr;
+        for (const auto &city : civilization.getCities())
+        {
+            if (!largestCity || city->population > largestCity->population)
+                largestCity = city.get();
+        }
+
+        json.beginObject();
+        json.field("seed", seed);
+        json.field("width", width);
+        json.field("height", height);
+        json.field("islandMode", options.islandMode == World::IslandMode::ARCHIPELAGO ? "archipelago" : "single");
+        json.field("erosionEngine", pipeErosion ? "pipe" : "droplets");
+        json.field("droplets", options.droplets);
+        json.field("dropletsCompleted", dropletsCompleted);
+        json.field("multiresolutionFactor", options.multiresolutionFactor);
+        json.field("thermalSweeps", options.thermalSweeps);
+        json.field("erosionSchedule", options.erosionSchedule == ErosionSimulator::Schedule::TILED ? "tiled" : "sequential");
+        json.field("dropletKernel", options.dropletKernel == ErosionSimulator::DropletKernel::BATCHED ? "batched" : "scalar");
+        json.field("years", options.years);
+
+        json.key("timingsMs");
+        json.beginObject();
+        json.field("generation", generationMs);
+        json.field("erosion", erosionMs);
+        json.field("climate", climateMs);
+        json.field("civilization", civilizationMs);
+        json.field("total", millisecondsSince(runStart));
+        json.endObject();
+
+        json.field("landCoverage", elevationStats.landTiles * 100.0 / ((double)width * height));
+        json.key("elevation");
+        json.beginObject();
+        json.field("min", (double)elevationStats.minElevation);
+        json.field("max", (double)elevationStats.maxElevation);
+        json.endObject();
+
+        json.key("biomes");
+        json.beginObject();
+        for (int biome = 0; biome < biomeCount; biome++)
+        {
+            json.field(BiomeInfo::getName((BiomeType)biome), biomeHistogram[biome]);
+        }
+        json.endObject();
+
+        json.key("cities");
+        json.beginObject();
+        json.field("count", civilization.getCityCount());
+        json.field("roads", civilization.getRoadCount());
+        json.field("totalPopulation", (long long)civilization.getTotalPopulation());
+        json.field("meanPopulation", civilization.getCityCount() > 0 ? (double)civilization.getTotalPopulation() / civilization.getCityCount() : 0.0);
+        if (largestCity)
+        {
+            json.key("largest");
+            json.beginObject();
+            json.field("name", largestCity->name);
+            json.field("population", largestCity->population);
+            json.endObject();
+        }
+        json.endObject();
+
+        json.endObject();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BatchOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool valid = true;
+        if (arg == "--seeds" && i + 1 < argc)
+        {
+            valid = parseList<int>(argv[++i], options.seeds, parseSeed);
+        }
+        else if (arg == "--sizes" && i + 1 < argc)
+        {
+            valid = parseList<std::pair<int, int>>(argv[++i], options.sizes, parseSize);
+        }
+        else if (arg == "--archipelago")
+        {
+            options.islandMode = World::IslandMode::ARCHIPELAGO;
+        }
+        else if (arg == "--droplets" && i + 1 < argc)
+        {
+            options.droplets = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--pipe-erosion")
+        {
+            options.erosionEngine = ErosionSimulator::Engine::PIPE;
+        }
+        else if (arg == "--pipe-iterations" && i + 1 < argc)
+        {
+            options.pipeIterations = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--multiresolution" && i + 1 < argc)
+        {
+            options.multiresolutionFactor = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--thermal" && i + 1 < argc)
+        {
+            options.thermalSweeps = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--sequential-erosion")
+        {
+            options.erosionSchedule = ErosionSimulator::Schedule::SEQUENTIAL;
+        }
+        else if (arg == "--erosion-time-limit" && i + 1 < argc)
+        {
+            options.erosionTimeLimitMs = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (arg == "--droplet-kernel" && i + 1 < argc)
+        {
+            std::string kernel = argv[++i];
+            valid = kernel == "scalar" || kernel == "batched";
+            options.dropletKernel = kernel == "scalar" ? ErosionSimulator::DropletKernel::SCALAR : ErosionSimulator::DropletKernel::BATCHED;
+        }
+        else if (arg == "--years" && i + 1 < argc)
+        {
+            options.years = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            Parallel::setThreadCount(std::atoi(argv[++i]));
+        }
+        else if (arg == "--processes" && i + 1 < argc)
+        {
+            options.processes = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--falloff-cache" && i + 1 < argc)
+        {
+            FalloffCache::setDiskCacheDirectory(argv[++i]);
+        }
+        else if (arg == "--output" && i + 1 < argc)
+        {
+            options.outputPath = argv[++i];
+        }
+        else if (arg == "--quiet")
+        {
+            options.quiet = true;
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!options.outputPath.empty())
+    {
+        outputFile.open(options.outputPath);
+        if (!outputFile)
+        {
+            std::cerr << "Could not open " << options.outputPath << " for writing" << std::endl;
+            return 1;
+        }
+    }
+
+    // The simulation logs to std::cout; send that to stderr (or nowhere) and keep stdout for JSON
+    std::ostream jsonStream(outputFile.is_open() ? outputFile.rdbuf() : std::cout.rdbuf());
+    std::cout.rdbuf(options.quiet ? nullptr : std::cerr.rdbuf());
+
+    JsonWriter json(jsonStream);
+    json.beginObject();
+    json.field("threads", Parallel::getThreadCount());
+    json.field("processes", options.processes);
+    json.key("runs");
+    json.beginArray();
+    for (const auto &[width, height] : options.sizes)
+    {
+        for (int seed : options.seeds)
+        {
+            runPipeline(options, seed, width, height, json);
+        }
+    }
+    json.endArray();
+    json.endObject();
+    jsonStream << std::endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "ChunkedWorld.h"
+#include "Noise.h"
+#include "Random.h"
+#include <algorithm>
+#include <cmath>
+
+ChunkedWorld::ChunkedWorld(int worldWidth, int worldHeight, int tileSize, int seed, const Settings &settings)
+    : worldWidth(worldWidth), worldHeight(worldHeight), tileSize(tileSize), seed(seed), settings(settings)
+{
+    this->settings.chunkSize = std::max(1, settings.chunkSize);
+    this->settings.maxChunks = std::max(1, settings.maxChunks);
+    chunksX = (worldWidth + this->settings.chunkSize - 1) / this->settings.chunkSize;
+    chunksY = (worldHeight + this->settings.chunkSize - 1) / this->settings.chunkSize;
+}
+
+int ChunkedWorld::getHaloSize() const
+{
+    int halo = 0;
+
+    if (settings.dropletsPerChunk > 0)
+    {
+        halo += erosion.getDropletReach();
+    }
+
+    // Climate then needs the eroded elevation that far around the chunk
+    if (settings.climate)
+    {
+        halo += ClimateSystem(0, 0).getInfluenceRadius();
+    }
+
+    return halo;
+}
+
+std::shared_ptr<const WorldChunk> ChunkedWorld::getChunk(int chunkX, int chunkY)
+{
+    const uint64_t key = chunkKey(chunkX, chunkY);
+
+    auto found = chunkCache.find(key);
+    if (found != chunkCache.end())
+    {
+        cacheStats.hits++;
+        recentChunks.splice(recentChunks.begin(), recentChunks, found->second.position);
+        return found->second.chunk;
+    }
+
+    std::shared_ptr<const WorldChunk> chunk = generateChunk(chunkX, chunkY);
+    cacheStats.generated++;
+
+    recentChunks.push_front(key);
+    chunkCache[key] = CacheEntry{chunk, recentChunks.begin()};
+
+    // Evicted chunks stay alive while a caller still holds them
+    while ((int)chunkCache.size() > settings.maxChunks)
+    {
+        chunkCache.erase(recentChunks.back());
+        recentChunks.pop_back();
+        cacheStats.evicted++;
+    }
+
+    return chunk;
+}
+
+void ChunkedWorld::prefetch(int x0, int y0, int x1, int y1)
+{
+    const int size = settings.chunkSize;
+    const int firstX = std::max(0, x0 / size);
+    const int firstY = std::max(0, y0 / size);
+    const int lastX = std::min(chunksX - 1, (x1 - 1) / size);
+    const int lastY = std::min(chunksY - 1, (y1 - 1) / size);
+
+    for (int cy = firstY; cy <= lastY; cy++)
+    {
+        for (int cx = firstX; cx <= lastX; cx++)
+        {
+            getChunk(cx, cy);
+        }
+    }
+}
+
+// Droplets are spawned per chunk-sized block of the whole world and keyed by block and droplet
+// index, so every chunk that needs a droplet sees it at the same place and in the same order.
+void ChunkedWorld::appendDropletStarts(std::vector<std::pair<float, float>> &starts, int x0, int y0, int x1, int y1)
+{
+    const int size = settings.chunkSize;
+    for (int by = y0 / size; by <= (y1 - 1) / size; by++)
+    {
+        for (int bx = x0 / size; bx <= (x1 - 1) / size; bx++)
+        {
+            const uint64_t firstDroplet = ((uint64_t)by * chunksX + bx) * (uint64_t)settings.dropletsPerChunk;
+
+            // Same range as ErosionSimulator::erode: never past the last interpolation cell
+            const float blockX = (float)(bx * size);
+            const float blockY = (float)(by * size);
+            const float spanX = std::min((float)size, (float)(worldWidth - 1) - blockX);
+            const float spanY = std::min((float)size, (float)(worldHeight - 1) - blockY);
+
+            for (int i = 0; i < settings.dropletsPerChunk; i++)
+            {
+                Random::Generator random((uint32_t)seed, Random::Subsystem::CHUNK_DROPLETS, firstDroplet + i);
+                float startX = blockX + random.nextFloat() * spanX;
+                float startY = blockY + random.nextFloat() * spanY;
+
+                if (startX >= x0 && startX < x1 && startY >= y0 && startY < y1)
+                {
+                    starts.emplace_back(startX - x0, startY - y0);
+                }
+            }
+        }
+    }
+}
+
+std::shared_ptr<const WorldChunk> ChunkedWorld::generateChunk(int chunkX, int chunkY)
+{
+    const int size = settings.chunkSize;
+    const int x0 = chunkX * size;
+    const int y0 = chunkY * size;
+    const int x1 = std::min(worldWidth, x0 + size);
+    const int y1 = std::min(worldHeight, y0 + size);
+
+    // Generate the chunk plus its halo, clipped to the world
+    const int halo = getHaloSize();
+    const int paddedX0 = std::max(0, x0 - halo);
+    const int paddedY0 = std::max(0, y0 - halo);
+    const int paddedX1 = std::min(worldWidth, x1 + halo);
+    const int paddedY1 = std::min(worldHeight, y1 + halo);
+    const int paddedWidth = paddedX1 - paddedX0;
+    const int paddedHeight = paddedY1 - paddedY0;
+
+    World region(paddedWidth, paddedHeight, tileSize, seed);
+    region.setIslandMode(settings.islandMode);
+    region.setRegion(paddedX0, paddedY0, worldWidth, worldHeight);
+    region.setVerbose(false);
+    region.generate();
+
+    if (settings.dropletsPerChunk > 0)
+    {
+        std::vector<std::pair<float, float>> starts;
+        appendDropletStarts(starts, paddedX0, paddedY0, paddedX1, paddedY1);
+        erosion.simulateDroplets(region, starts);
+        region.assignTerrainTypes();
+    }
+
+    std::unique_ptr<ClimateSystem> climate;
+    if (settings.climate)
+    {
+        climate = std::make_unique<ClimateSystem>(paddedWidth, paddedHeight);
+        climate->setLatitudeFrame(paddedY0, worldHeight);
+        climate->setVerbose(false);
+        // Drainage basins and wind tracks run past any halo; only the local models stitch seamlessly
+        climate->setDrainageEnabled(false);
+        climate->setMoistureModel(ClimateSystem::MoistureModel::DISTANCE);
+        climate->generateClimate(region);
+    }
+
+    // Keep only the chunk's own cells
+    auto chunk = std::make_shared<WorldChunk>();
+    chunk->chunkX = chunkX;
+    chunk->chunkY = chunkY;
+    chunk->originX = x0;
+    chunk->originY = y0;
+    chunk->elevation.resize(x1 - x0, y1 - y0);
+    chunk->terrain.resize(x1 - x0, y1 - y0);
+    if (climate)
+    {
+        chunk->biomes.resize(x1 - x0, y1 - y0);
+    }
+
+    const int offsetX = x0 - paddedX0;
+    const int offsetY = y0 - paddedY0;
+    for (int y = 0; y < y1 - y0; y++)
+    {
+        const float *elevationRow = region.getElevationMap().row(offsetY + y) + offsetX;
+        const TerrainType *terrainRow = region.getTerrainMap().row(offsetY + y) + offsetX;
+        std::copy(elevationRow, elevationRow + (x1 - x0), chunk->elevation.row(y));
+        std::copy(terrainRow, terrainRow + (x1 - x0), chunk->terrain.row(y));
+
+        if (climate)
+        {
+            const BiomeType *biomeRow = climate->getBiomeMap().row(offsetY + y) + offsetX;
+            std::copy(biomeRow, biomeRow + (x1 - x0), chunk->biomes.row(y));
+        }
+    }
+
+    return chunk;
+}
+
+float ChunkedWorld::getElevation(int x, int y)
+{
+    if (x < 0 || x >= worldWidth || y < 0 || y >= worldHeight)
+    {
+        return -1.0f; // Out of bounds
+    }
+
+    std::shared_ptr<const WorldChunk> chunk = getChunk(x / settings.chunkSize, y / settings.chunkSize);
+    return chunk->elevation(x - chunk->originX, y - chunk->originY);
+}
+
+TerrainType ChunkedWorld::getTerrain(int x, int y)
+{
+    if (x < 0 || x >= worldWidth || y < 0 || y >= worldHeight)
+    {
+        return TerrainType::DEEP_WATER; // Out of bounds
+    }
+
+    std::shared_ptr<const WorldChunk> chunk = getChunk(x / settings.chunkSize, y / settings.chunkSize);
+    return chunk->terrain(x - chunk->originX, y - chunk->originY);
+}
\ No newline at end of file
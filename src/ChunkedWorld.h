@@ -0,0 +1,105 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "Grid2D.h"
+#include "World.h"
+#include "Climate.h"
+#include "Erosion.h"
+
+// One fixed-size square of a chunked world. Chunks on the far edge may be smaller.
+struct WorldChunk
+{
+    int chunkX = 0;
+    int chunkY = 0;
+    int originX = 0; // world coordinates of the top-left cell
+    int originY = 0;
+
+    Grid2D<float> elevation;
+    Grid2D<TerrainType> terrain;
+    Grid2D<BiomeType> biomes; // empty unless climate is enabled
+};
+
+// A world too large to hold in memory at once. Chunks are generated from the seed when first
+// touched, kept in a bounded LRU cache and regenerated identically after eviction.
+// Each chunk is generated with a margin of neighbouring cells (the halo) so that erosion and
+// climate see the same surroundings a full-map generation would.
+class ChunkedWorld
+{
+public:
+    struct Settings
+    {
+        int chunkSize = 128;
+        int maxChunks = 256;         // LRU capacity; keep above the chunks one screen can show
+        int dropletsPerChunk = 0;    // erosion droplets per chunk-sized block of the world (0 = no erosion)
+        bool climate = false;        // generate biomes per chunk
+        World::IslandMode islandMode = World::IslandMode::SINGLE;
+    };
+
+    struct CacheStats
+    {
+        long long hits = 0;
+        long long generated = 0;
+        long long evicted = 0;
+    };
+
+private:
+    int worldWidth;
+    int worldHeight;
+    int tileSize;
+    int seed;
+    Settings settings;
+    int chunksX;
+    int chunksY;
+
+    ErosionSimulator erosion;
+
+    // Most recently used chunk at the front
+    std::list<uint64_t> recentChunks;
+    struct CacheEntry
+    {
+        std::shared_ptr<const WorldChunk> chunk;
+        std::list<uint64_t>::iterator position;
+    };
+    std::unordered_map<uint64_t, CacheEntry> chunkCache;
+    CacheStats cacheStats;
+
+    static uint64_t chunkKey(int chunkX, int chunkY) { return ((uint64_t)(uint32_t)chunkY << 32) | (uint32_t)chunkX; }
+
+    std::shared_ptr<const WorldChunk> generateChunk(int chunkX, int chunkY);
+    void appendDropletStarts(std::vector<std::pair<float, float>> &starts, int x0, int y0, int x1, int y1);
+    int getHaloSize() const;
+
+    template <typename ColorFunction>
+    void renderVisible(sf::RenderWindow &window, ColorFunction colorAt);
+
+public:
+    ChunkedWorld(int worldWidth, int worldHeight, int tileSize, int seed, const Settings &settings);
+
+    // Returns the chunk, generating it (and evicting the least recently used one) if needed.
+    // Chunk coordinates must lie inside the world.
+    std::shared_ptr<const WorldChunk> getChunk(int chunkX, int chunkY);
+
+    // Generates every chunk overlapping the cell rectangle ahead of time
+    void prefetch(int x0, int y0, int x1, int y1);
+
+    void render(sf::RenderWindow &window);
+    void renderHeightmap(sf::RenderWindow &window);
+    void renderBiomes(sf::RenderWindow &window);
+
+    // Per-cell access in world coordinates; loads the chunk on demand
+    float getElevation(int x, int y);
+    TerrainType getTerrain(int x, int y);
+
+    ErosionSimulator &getErosion() { return erosion; }
+
+    int getWorldWidth() const { return worldWidth; }
+    int getWorldHeight() const { return worldHeight; }
+    int getChunkSize() const { return settings.chunkSize; }
+    int getSeed() const { return seed; }
+    const Settings &getSettings() const { return settings; }
+    const CacheStats &getCacheStats() const { return cacheStats; }
+    int getLoadedChunkCount() const { return (int)chunkCache.size(); }
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "ChunkedWorld.h"
+#include "RenderColors.h"
+#include "Noise.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Draws only the cells inside the current view, loading their chunks as needed
+template <typename ColorFunction>
+void ChunkedWorld::renderVisible(sf::RenderWindow &window, ColorFunction colorAt)
+{
+    const sf::View &view = window.getView();
+    const sf::Vector2f topLeft = view.getCenter() - view.getSize() / 2.0f;
+    const sf::Vector2f bottomRight = view.getCenter() + view.getSize() / 2.0f;
+
+    const int x0 = std::max(0, (int)std::floor(topLeft.x / tileSize));
+    const int y0 = std::max(0, (int)std::floor(topLeft.y / tileSize));
+    const int x1 = std::min(worldWidth, (int)std::ceil(bottomRight.x / tileSize) + 1);
+    const int y1 = std::min(worldHeight, (int)std::ceil(bottomRight.y / tileSize) + 1);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, (size_t)(x1 - x0) * (y1 - y0) * 6);
+    size_t index = 0;
+
+    const int size = settings.chunkSize;
+    for (int cy = y0 / size; cy <= (y1 - 1) / size; cy++)
+    {
+        for (int cx = x0 / size; cx <= (x1 - 1) / size; cx++)
+        {
+            std::shared_ptr<const WorldChunk> chunk = getChunk(cx, cy);
+            const int chunkX1 = std::min(x1, chunk->originX + chunk->elevation.getWidth());
+            const int chunkY1 = std::min(y1, chunk->originY + chunk->elevation.getHeight());
+
+            for (int y = std::max(y0, chunk->originY); y < chunkY1; y++)
+            {
+                for (int x = std::max(x0, chunk->originX); x < chunkX1; x++)
+                {
+                    sf::Color color = colorAt(*chunk, x - chunk->originX, y - chunk->originY, x, y);
+
+                    float left = x * tileSize;
+                    float top = y * tileSize;
+                    float right = left + tileSize;
+                    float bottom = top + tileSize;
+
+                    vertices[index + 0].position = sf::Vector2f(left, top);
+                    vertices[index + 1].position = sf::Vector2f(right, top);
+                    vertices[index + 2].position = sf::Vector2f(left, bottom);
+                    vertices[index + 3].position = sf::Vector2f(right, top);
+                    vertices[index + 4].position = sf::Vector2f(right, bottom);
+                    vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+                    for (int i = 0; i < 6; i++)
+                    {
+                        vertices[index + i].color = color;
+                    }
+                    index += 6;
+                }
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
+
+void ChunkedWorld::render(sf::RenderWindow &window)
+{
+    auto terrainColor = [this](const WorldChunk &chunk, int localX, int localY, int x, int y)
+    {
+        sf::Color baseColor = TerrainColor::getColor(chunk.terrain(localX, localY));
+
+        // Same texture variation as World::render, keyed on world coordinates
+        int variation = (int)(Noise::hash(x, y, seed * 7) * 10) - 5;
+        return sf::Color(
+            std::max(0, std::min(255, baseColor.r + variation)),
+            std::max(0, std::min(255, baseColor.g + variation)),
+            std::max(0, std::min(255, baseColor.b + variation)));
+    };
+    renderVisible(window, terrainColor);
+}
+
+void ChunkedWorld::renderHeightmap(sf::RenderWindow &window)
+{
+    auto heightColor = [](const WorldChunk &chunk, int localX, int localY, int, int)
+    {
+        int gray = (int)((chunk.elevation(localX, localY) + 1.0f) * 0.5f * 255.0f);
+        gray = std::max(0, std::min(255, gray));
+        return sf::Color(gray, gray, gray);
+    };
+    renderVisible(window, heightColor);
+}
+
+void ChunkedWorld::renderBiomes(sf::RenderWindow &window)
+{
+    if (!settings.climate)
+    {
+        render(window);
+        return;
+    }
+
+    auto biomeColor = [](const WorldChunk &chunk, int localX, int localY, int, int)
+    {
+        return BiomeColor::getColor(chunk.biomes(localX, localY));
+    };
+    renderVisible(window, biomeColor);
+}
\ No newline at end of file
@@ -1,21 +1,20 @@
 #include "Civilization.h"
 #include "World.h"
 #include "Climate.h"
+#include "Random.h"
 #include <cmath>
 #include <algorithm>
 #include <queue>
-#include <random>
 #include <iostream>
-#include <set>
-#include <map>
+#include <limits>
 
 CivilizationSystem::CivilizationSystem(int width, int height)
     : width(width), height(height), currentYear(0)
 {
 
-    territoryMap.resize(height, std::vector<int>(width, -1));
-    developmentMap.resize(height, std::vector<float>(width, 0.0f));
-    movementCost.resize(height, std::vector<float>(width, 1.0f));
+    territoryMap.resize(width, height, -1);
+    developmentMap.resize(width, height, 0.0f);
+    movementCost.resize(width, height, 1.0f);
 }
 
 void CivilizationSystem::initialize(const World &world, const ClimateSystem &climate)
@@ -46,7 +45,7 @@ void CivilizationSystem::calculateMovementCosts(const World &world, const Climat
             // Base cost on terrain type
             if (elevation < 0.0f)
             {
-                movementCost[y][x] = 999.0f; // Can't build roads on water
+                movementCost(x, y) = 999.0f; // Can't build roads on water
             }
             else
             {
@@ -76,21 +75,17 @@ void CivilizationSystem::calculateMovementCosts(const World &world, const Climat
                     break;
                 }
 
-                movementCost[y][x] = cost;
+                movementCost(x, y) = cost;
             }
         }
     }
 }
 
-std::string CivilizationSystem::generateCityName()
+std::string CivilizationSystem::generateCityName(int seed, int cityIndex)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-
-    std::uniform_int_distribution<> prefixDist(0, namePrefix.size() - 1);
-    std::uniform_int_distribution<> suffixDist(0, nameSuffix.size() - 1);
-
-    return namePrefix[prefixDist(gen)] + " " + nameSuffix[suffixDist(gen)];
+    Random::Generator random((uint32_t)seed, Random::Subsystem::CITY_NAMES, (uint64_t)cityIndex);
+    const std::string &prefix = namePrefix[random.nextInt((int)namePrefix.size())];
+    return prefix + " " + nameSuffix[random.nextInt((int)nameSuffix.size())];
 }
 
 float CivilizationSystem::calculateSiteSuitability(const World &world, const ClimateSystem &climate, int x, int y)
@@ -198,10 +193,16 @@ void CivilizationSystem::placeInitialCities(const World &world, const ClimateSys
     // Find best sites for cities
     std::vector<std::tuple<float, int, int>> potentialSites;
 
+    // Only land can score, so sample the land cells of every other row and column
+    const LandIndex &land = world.getLandIndex();
     for (int y = 10; y < height - 10; y += 2)
     {
-        for (int x = 10; x < width - 10; x += 2)
+        for (uint32_t i = land.rowStart[y]; i < land.rowStart[y + 1]; i++)
         {
+            const int x = (int)(land.cells[i] % width);
+            if (x < 10 || x >= width - 10 || x % 2 != 0)
+                continue;
+
             float suitability = calculateSiteSuitability(world, climate, x, y);
             if (suitability > 0)
             {
@@ -221,7 +222,7 @@ void CivilizationSystem::placeInitialCities(const World &world, const ClimateSys
     {
         if (canPlaceCity(x, y))
         {
-            auto city = std::make_unique<City>(x, y, generateCityName(), currentYear);
+            auto city = std::make_unique<City>(x, y, generateCityName(world.getSeed(), (int)cities.size()), currentYear);
 
             // Capital city gets bonus
             if (citiesPlaced == 0)
@@ -323,9 +324,11 @@ std::vector<std::pair<int, int>> CivilizationSystem::findPath(int startX, int st
     };
 
     std::priority_queue<Node, std::vector<Node>, std::greater<Node>> openSet;
-    std::set<std::pair<int, int>> closedSet;
-    std::map<std::pair<int, int>, std::pair<int, int>> parentMap;
-    std::map<std::pair<int, int>, float> gScore;
+
+    // Dense per-cell bookkeeping instead of ordered maps keyed by coordinates
+    Grid2D<unsigned char> closedSet(width, height, 0);
+    Grid2D<int> parentMap(width, height, -1); // flat index of parent cell, -1 = none
+    Grid2D<float> gScore(width, height, std::numeric_limits<float>::infinity());
 
     // Heuristic function
     auto heuristic = [](int x1, int y1, int x2, int y2) -> float
@@ -337,7 +340,7 @@ std::vector<std::pair<int, int>> CivilizationSystem::findPath(int startX, int st
     Node start{startX, startY, 0, heuristic(startX, startY, endX, endY), 0, {-1, -1}};
     start.f = start.g + start.h;
     openSet.push(start);
-    gScore[{startX, startY}] = 0;
+    gScore(startX, startY) = 0;
 
     while (!openSet.empty())
     {
@@ -349,26 +352,19 @@ std::vector<std::pair<int, int>> CivilizationSystem::findPath(int startX, int st
         {
             // Reconstruct path
             std::vector<std::pair<int, int>> path;
-            std::pair<int, int> pos = {current.x, current.y};
+            int pos = (int)parentMap.index(current.x, current.y);
 
-            while (pos.first != -1)
+            while (pos != -1)
             {
-                path.push_back(pos);
-                if (parentMap.find(pos) != parentMap.end())
-                {
-                    pos = parentMap[pos];
-                }
-                else
-                {
-                    break;
-                }
+                path.push_back({pos % width, pos / width});
+                pos = parentMap[pos];
             }
 
             std::reverse(path.begin(), path.end());
             return path;
         }
 
-        closedSet.insert({current.x, current.y});
+        closedSet(current.x, current.y) = 1;
 
         // Check neighbors
         for (int dy = -1; dy <= 1; dy++)
@@ -383,18 +379,18 @@ std::vector<std::pair<int, int>> CivilizationSystem::findPath(int startX, int st
 
                 if (nx < 0 || nx >= width || ny < 0 || ny >= height)
                     continue;
-                if (closedSet.find({nx, ny}) != closedSet.end())
+                if (closedSet(nx, ny))
                     continue;
-                if (movementCost[ny][nx] > 100.0f)
+                if (movementCost(nx, ny) > 100.0f)
                     continue; // Impassable
 
-                float tentativeG = current.g + movementCost[ny][nx] *
+                float tentativeG = current.g + movementCost(nx, ny) *
                                                    ((dx != 0 && dy != 0) ? 1.414f : 1.0f);
 
-                if (gScore.find({nx, ny}) == gScore.end() || tentativeG < gScore[{nx, ny}])
+                if (tentativeG < gScore(nx, ny))
                 {
-                    gScore[{nx, ny}] = tentativeG;
-                    parentMap[{nx, ny}] = {current.x, current.y};
+                    gScore(nx, ny) = tentativeG;
+                    parentMap(nx, ny) = (int)parentMap.index(current.x, current.y);
 
                     Node neighbor{nx, ny, tentativeG, heuristic(nx, ny, endX, endY), 0, {current.x, current.y}};
                     neighbor.f = neighbor.g + neighbor.h;
@@ -437,7 +433,7 @@ void CivilizationSystem::simulate(const World &world, const ClimateSystem &clima
         {
             for (int x = 10; x < width - 10; x += 5)
             {
-                if (territoryMap[y][x] == -1 && canPlaceCity(x, y, 15))
+                if (territoryMap(x, y) == -1 && canPlaceCity(x, y, 15))
                 {
                     float suit = calculateSiteSuitability(world, climate, x, y);
                     if (suit > bestSuitability)
@@ -452,7 +448,7 @@ void CivilizationSystem::simulate(const World &world, const ClimateSystem &clima
 
         if (bestX != -1 && bestSuitability > 20)
         {
-            auto city = std::make_unique<City>(bestX, bestY, generateCityName(), currentYear);
+            auto city = std::make_unique<City>(bestX, bestY, generateCityName(world.getSeed(), (int)cities.size()), currentYear);
             cities.push_back(std::move(city));
             expandTerritory(cities.size() - 1, world);
             connectCities(); // Rebuild road network
@@ -488,8 +484,9 @@ void CivilizationSystem::growCity(City &city, const World &world, const ClimateS
     // Trade connections boost growth
     growthModifier *= 1.0f + (city.connectedCities.size() * 0.1f);
 
-    // Apply growth
-    city.population = (int)(city.population * city.growthRate * growthModifier);
+    // Apply growth, capped so long simulations cannot overflow the population
+    double grown = city.population * (double)(city.growthRate * growthModifier);
+    city.population = (int)std::min(grown, (double)maxCityPopulation);
     city.resources += city.population * 0.01f;
 
     // Larger cities grow slower
@@ -515,9 +512,15 @@ void CivilizationSystem::expandTerritory(int cityIndex, const World &world)
     const City &city = *cities[cityIndex];
     int radius = 5 + (city.population / 1000);
 
-    for (int dy = -radius; dy <= radius; dy++)
+    // Only the part of the circle inside the map can be claimed
+    const int minY = std::max(-radius, -city.y);
+    const int maxY = std::min(radius, height - 1 - city.y);
+    const int minX = std::max(-radius, -city.x);
+    const int maxX = std::min(radius, width - 1 - city.x);
+
+    for (int dy = minY; dy <= maxY; dy++)
     {
-        for (int dx = -radius; dx <= radius; dx++)
+        for (int dx = minX; dx <= maxX; dx++)
         {
             int x = city.x + dx;
             int y = city.y + dy;
@@ -527,9 +530,9 @@ void CivilizationSystem::expandTerritory(int cityIndex, const World &world)
                 float distance = std::sqrt(dx * dx + dy * dy);
                 if (distance <= radius && world.getElevation(x, y) > 0)
                 {
-                    if (territoryMap[y][x] == -1)
+                    if (territoryMap(x, y) == -1)
                     {
-                        territoryMap[y][x] = cityIndex;
+                        territoryMap(x, y) = cityIndex;
                     }
                 }
             }
@@ -544,7 +547,7 @@ void CivilizationSystem::updateDevelopment()
     {
         for (int x = 0; x < width; x++)
         {
-            developmentMap[y][x] *= 0.99f;
+            developmentMap(x, y) *= 0.99f;
         }
     }
 
@@ -567,7 +570,7 @@ void CivilizationSystem::updateDevelopment()
                     if (distance <= devRadius)
                     {
                         float influence = devStrength * (1.0f - distance / devRadius);
-                        developmentMap[y][x] = std::min(1.0f, developmentMap[y][x] + influence * 0.1f);
+                        developmentMap(x, y) = std::min(1.0f, developmentMap(x, y) + influence * 0.1f);
                     }
                 }
             }
@@ -581,245 +584,12 @@ void CivilizationSystem::updateDevelopment()
         {
             if (x >= 0 && x < width && y >= 0 && y < height)
             {
-                developmentMap[y][x] = std::min(1.0f, developmentMap[y][x] + 0.05f);
+                developmentMap(x, y) = std::min(1.0f, developmentMap(x, y) + 0.05f);
             }
         }
     }
 }
 
-void CivilizationSystem::render(sf::RenderWindow &window, int tileSize)
-{
-    // Render roads as dotted lines
-    for (const auto &road : roads)
-    {
-        // Draw road segments with gaps for dotted effect
-        for (size_t i = 0; i < road->path.size() - 1; i++)
-        {
-            // Only draw every other segment for dotted line effect
-            if (i % 3 < 2)
-            {
-                sf::Vertex line[2];
-                line[0].position = sf::Vector2f(
-                    road->path[i].first * tileSize + tileSize / 2,
-                    road->path[i].second * tileSize + tileSize / 2);
-                line[0].color = sf::Color(101, 67, 33); // Dark brown
-                line[1].position = sf::Vector2f(
-                    road->path[i + 1].first * tileSize + tileSize / 2,
-                    road->path[i + 1].second * tileSize + tileSize / 2);
-                line[1].color = sf::Color(101, 67, 33);
-                window.draw(line, 2, sf::PrimitiveType::Lines);
-            }
-        }
-    }
-
-    // Render cities as buildings
-    for (const auto &city : cities)
-    {
-        float x = city->x * tileSize;
-        float y = city->y * tileSize;
-
-        // City size scales with population - DOUBLED base scale
-        float scale = 1.6f + std::min(2.4f, (float)(std::log10(city->population + 1) * 0.6f));
-
-        // Draw city based on size
-        if (city->population < 1000)
-        {
-            // Small village - simple hut
-            // Roof (triangle)
-            sf::ConvexShape roof;
-            roof.setPointCount(3);
-            roof.setPoint(0, sf::Vector2f(x + tileSize / 2, y - 4 * scale));
-            roof.setPoint(1, sf::Vector2f(x - 4 * scale, y + tileSize / 2));
-            roof.setPoint(2, sf::Vector2f(x + tileSize + 4 * scale, y + tileSize / 2));
-            roof.setFillColor(sf::Color(139, 69, 19)); // Brown roof
-            window.draw(roof);
-
-            // Base (rectangle)
-            sf::RectangleShape base(sf::Vector2f(tileSize * scale * 2, tileSize * 1.2f * scale));
-            base.setPosition(sf::Vector2f(x + tileSize * (1 - scale) / 2 - tileSize * scale / 2, y + tileSize * 0.4f));
-            base.setFillColor(sf::Color(222, 184, 135)); // Tan walls
-            window.draw(base);
-
-            // Door
-            sf::RectangleShape door(sf::Vector2f(tileSize * 0.4f * scale, tileSize * 0.8f * scale));
-            door.setPosition(sf::Vector2f(x + tileSize * 0.3f, y + tileSize * 0.6f));
-            door.setFillColor(sf::Color(101, 67, 33)); // Dark brown door
-            window.draw(door);
-        }
-        else if (city->population < 5000)
-        {
-            // Medium town - multiple buildings
-            for (int i = 0; i < 3; i++)
-            {
-                float offsetX = (i - 1) * tileSize * 0.8f * scale;
-                float offsetY = (i == 1) ? -tileSize * 0.4f * scale : 0;
-
-                // Building
-                sf::RectangleShape building(sf::Vector2f(tileSize * 1.0f * scale, tileSize * 1.4f * scale));
-                building.setPosition(sf::Vector2f(x + offsetX + tileSize * 0.0f, y + offsetY + tileSize * 0.1f));
-                building.setFillColor(sf::Color(205, 133, 63)); // Peru color
-                window.draw(building);
-
-                // Roof
-                sf::ConvexShape smallRoof;
-                smallRoof.setPointCount(3);
-                smallRoof.setPoint(0, sf::Vector2f(x + offsetX + tileSize / 2, y + offsetY - tileSize * 0.2f * scale));
-                smallRoof.setPoint(1, sf::Vector2f(x + offsetX - tileSize * 0.1f * scale, y + offsetY + tileSize * 0.2f));
-                smallRoof.setPoint(2, sf::Vector2f(x + offsetX + tileSize * 1.1f * scale, y + offsetY + tileSize * 0.2f));
-                smallRoof.setFillColor(sf::Color(139, 69, 19));
-                window.draw(smallRoof);
-            }
-        }
-        else
-        {
-            // Large city - castle/tower
-            // Tower base
-            sf::RectangleShape tower(sf::Vector2f(tileSize * 1.6f * scale, tileSize * 2.0f * scale));
-            tower.setPosition(sf::Vector2f(x - tileSize * 0.3f * scale, y - tileSize * 0.5f * scale));
-            tower.setFillColor(sf::Color(105, 105, 105)); // Dim gray stone
-            window.draw(tower);
-
-            // Tower top
-            sf::RectangleShape towerTop(sf::Vector2f(tileSize * 2.0f * scale, tileSize * 0.6f * scale));
-            towerTop.setPosition(sf::Vector2f(x - tileSize * 0.5f * scale, y - tileSize * 1.1f * scale));
-            towerTop.setFillColor(sf::Color(105, 105, 105));
-            window.draw(towerTop);
-
-            // Battlements
-            for (int i = 0; i < 4; i++)
-            {
-                sf::RectangleShape battlement(sf::Vector2f(tileSize * 0.3f * scale, tileSize * 0.4f * scale));
-                battlement.setPosition(sf::Vector2f(x - tileSize * 0.4f * scale + i * tileSize * 0.5f * scale, y - tileSize * 1.5f * scale));
-                battlement.setFillColor(sf::Color(105, 105, 105));
-                window.draw(battlement);
-            }
-
-            // Flag (for capital or large cities)
-            if (city->population > 10000)
-            {
-                // Flag pole
-                sf::RectangleShape pole(sf::Vector2f(4, tileSize * 1.2f * scale));
-                pole.setPosition(sf::Vector2f(x + tileSize * 0.9f * scale, y - tileSize * 2.0f * scale));
-                pole.setFillColor(sf::Color(101, 67, 33));
-                window.draw(pole);
-
-                // Flag
-                sf::ConvexShape flag;
-                flag.setPointCount(3);
-                flag.setPoint(0, sf::Vector2f(x + tileSize * 0.9f * scale + 4, y - tileSize * 2.0f * scale));
-                flag.setPoint(1, sf::Vector2f(x + tileSize * 0.9f * scale + tileSize * 0.6f, y - tileSize * 1.6f * scale));
-                flag.setPoint(2, sf::Vector2f(x + tileSize * 0.9f * scale + 4, y - tileSize * 1.2f * scale));
-                flag.setFillColor(sf::Color(220, 20, 60)); // Crimson
-                window.draw(flag);
-            }
-        }
-
-        // City name label (optional - comment out if too cluttered)
-        // Would need font support in SFML 3.0
-    }
-}
-
-void CivilizationSystem::renderTerritory(sf::RenderWindow &window, int tileSize)
-{
-    // Color palette for different civilizations
-    std::vector<sf::Color> territoryColors = {
-        sf::Color(255, 0, 0, 100),   // Red
-        sf::Color(0, 0, 255, 100),   // Blue
-        sf::Color(0, 255, 0, 100),   // Green
-        sf::Color(255, 255, 0, 100), // Yellow
-        sf::Color(255, 0, 255, 100), // Magenta
-        sf::Color(0, 255, 255, 100), // Cyan
-        sf::Color(255, 128, 0, 100), // Orange
-        sf::Color(128, 0, 255, 100), // Purple
-    };
-
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
-    int index = 0;
-
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            int territory = territoryMap[y][x];
-            if (territory >= 0)
-            {
-                sf::Color color = territoryColors[territory % territoryColors.size()];
-
-                float left = x * tileSize;
-                float top = y * tileSize;
-                float right = left + tileSize;
-                float bottom = top + tileSize;
-
-                // Create triangles
-                vertices[index + 0].position = sf::Vector2f(left, top);
-                vertices[index + 1].position = sf::Vector2f(right, top);
-                vertices[index + 2].position = sf::Vector2f(left, bottom);
-
-                vertices[index + 3].position = sf::Vector2f(right, top);
-                vertices[index + 4].position = sf::Vector2f(right, bottom);
-                vertices[index + 5].position = sf::Vector2f(left, bottom);
-
-                for (int i = 0; i < 6; i++)
-                {
-                    vertices[index + i].color = color;
-                }
-
-                index += 6;
-            }
-            else
-            {
-                index += 6;
-            }
-        }
-    }
-
-    vertices.resize(index);
-    window.draw(vertices);
-}
-
-void CivilizationSystem::renderDevelopment(sf::RenderWindow &window, int tileSize)
-{
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
-
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            int index = (y * width + x) * 6;
-
-            float development = developmentMap[y][x];
-            if (development > 0.01f)
-            {
-                // Yellow to red gradient for development
-                int red = 255;
-                int green = 255 * (1.0f - development);
-                sf::Color color(red, green, 0, 150);
-
-                float left = x * tileSize;
-                float top = y * tileSize;
-                float right = left + tileSize;
-                float bottom = top + tileSize;
-
-                // Create triangles
-                vertices[index + 0].position = sf::Vector2f(left, top);
-                vertices[index + 1].position = sf::Vector2f(right, top);
-                vertices[index + 2].position = sf::Vector2f(left, bottom);
-
-                vertices[index + 3].position = sf::Vector2f(right, top);
-                vertices[index + 4].position = sf::Vector2f(right, bottom);
-                vertices[index + 5].position = sf::Vector2f(left, bottom);
-
-                for (int i = 0; i < 6; i++)
-                {
-                    vertices[index + i].color = color;
-                }
-            }
-        }
-    }
-
-    window.draw(vertices);
-}
-
 int CivilizationSystem::getTotalPopulation() const
 {
     int total = 0;
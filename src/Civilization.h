@@ -3,8 +3,13 @@
 #include <vector>
 #include <string>
 #include <memory>
-#include <SFML/Graphics.hpp>
 #include "Climate.h"
+#include "Grid2D.h"
+
+namespace sf
+{
+    class RenderWindow;
+}
 
 class World;
 class ClimateSystem;
@@ -39,14 +44,15 @@ private:
     int width;
     int height;
     int currentYear;
+    int maxCityPopulation = 1000000;
 
     std::vector<std::unique_ptr<City>> cities;
     std::vector<std::unique_ptr<Road>> roads;
-    std::vector<std::vector<int>> territoryMap;     // -1 = unclaimed, else city index
-    std::vector<std::vector<float>> developmentMap; // 0-1 development level
+    Grid2D<int> territoryMap;     // -1 = unclaimed, else city index
+    Grid2D<float> developmentMap; // 0-1 development level
 
     // Pathfinding grid
-    std::vector<std::vector<float>> movementCost;
+    Grid2D<float> movementCost;
 
     // City name generator
     std::vector<std::string> namePrefix = {
@@ -59,7 +65,7 @@ private:
         "meadow", "grove", "ridge", "crest", "view", "harbor"};
 
     // Helper functions
-    std::string generateCityName();
+    std::string generateCityName(int seed, int cityIndex); // depends only on the seed and the city's index
     float calculateSiteSuitability(const World &world, const ClimateSystem &climate, int x, int y);
     bool canPlaceCity(int x, int y, int minDistance = 20);
     void growCity(City &city, const World &world, const ClimateSystem &climate);
@@ -85,6 +91,7 @@ public:
     // Getters
     int getYear() const { return currentYear; }
     int getCityCount() const { return cities.size(); }
+    int getRoadCount() const { return roads.size(); }
     int getTotalPopulation() const;
     const std::vector<std::unique_ptr<City>> &getCities() const { return cities; }
 };
\ No newline at end of file
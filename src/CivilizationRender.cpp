@@ -0,0 +1,238 @@
+#include "Civilization.h"
+#include "RenderColors.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+void CivilizationSystem::render(sf::RenderWindow &window, int tileSize)
+{
+    // Render roads as dotted lines
+    for (const auto &road : roads)
+    {
+        // Draw road segments with gaps for dotted effect
+        for (size_t i = 0; i < road->path.size() - 1; i++)
+        {
+            // Only draw every other segment for dotted line effect
+            if (i % 3 < 2)
+            {
+                sf::Vertex line[2];
+                line[0].position = sf::Vector2f(
+                    road->path[i].first * tileSize + tileSize / 2,
+                    road->path[i].second * tileSize + tileSize / 2);
+                line[0].color = sf::Color(101, 67, 33); // Dark brown
+                line[1].position = sf::Vector2f(
+                    road->path[i + 1].first * tileSize + tileSize / 2,
+                    road->path[i + 1].second * tileSize + tileSize / 2);
+                line[1].color = sf::Color(101, 67, 33);
+                window.draw(line, 2, sf::PrimitiveType::Lines);
+            }
+        }
+    }
+
+    // Render cities as buildings
+    for (const auto &city : cities)
+    {
+        float x = city->x * tileSize;
+        float y = city->y * tileSize;
+
+        // City size scales with population - DOUBLED base scale
+        float scale = 1.6f + std::min(2.4f, (float)(std::log10(city->population + 1) * 0.6f));
+
+        // Draw city based on size
+        if (city->population < 1000)
+        {
+            // Small village - simple hut
+            // Roof (triangle)
+            sf::ConvexShape roof;
+            roof.setPointCount(3);
+            roof.setPoint(0, sf::Vector2f(x + tileSize / 2, y - 4 * scale));
+            roof.setPoint(1, sf::Vector2f(x - 4 * scale, y + tileSize / 2));
+            roof.setPoint(2, sf::Vector2f(x + tileSize + 4 * scale, y + tileSize / 2));
+            roof.setFillColor(sf::Color(139, 69, 19)); // Brown roof
+            window.draw(roof);
+
+            // Base (rectangle)
+            sf::RectangleShape base(sf::Vector2f(tileSize * scale * 2, tileSize * 1.2f * scale));
+            base.setPosition(sf::Vector2f(x + tileSize * (1 - scale) / 2 - tileSize * scale / 2, y + tileSize * 0.4f));
+            base.setFillColor(sf::Color(222, 184, 135)); // Tan walls
+            window.draw(base);
+
+            // Door
+            sf::RectangleShape door(sf::Vector2f(tileSize * 0.4f * scale, tileSize * 0.8f * scale));
+            door.setPosition(sf::Vector2f(x + tileSize * 0.3f, y + tileSize * 0.6f));
+            door.setFillColor(sf::Color(101, 67, 33)); // Dark brown door
+            window.draw(door);
+        }
+        else if (city->population < 5000)
+        {
+            // Medium town - multiple buildings
+            for (int i = 0; i < 3; i++)
+            {
+                float offsetX = (i - 1) * tileSize * 0.8f * scale;
+                float offsetY = (i == 1) ? -tileSize * 0.4f * scale : 0;
+
+                // Building
+                sf::RectangleShape building(sf::Vector2f(tileSize * 1.0f * scale, tileSize * 1.4f * scale));
+                building.setPosition(sf::Vector2f(x + offsetX + tileSize * 0.0f, y + offsetY + tileSize * 0.1f));
+                building.setFillColor(sf::Color(205, 133, 63)); // Peru color
+                window.draw(building);
+
+                // Roof
+                sf::ConvexShape smallRoof;
+                smallRoof.setPointCount(3);
+                smallRoof.setPoint(0, sf::Vector2f(x + offsetX + tileSize / 2, y + offsetY - tileSize * 0.2f * scale));
+                smallRoof.setPoint(1, sf::Vector2f(x + offsetX - tileSize * 0.1f * scale, y + offsetY + tileSize * 0.2f));
+                smallRoof.setPoint(2, sf::Vector2f(x + offsetX + tileSize * 1.1f * scale, y + offsetY + tileSize * 0.2f));
+                smallRoof.setFillColor(sf::Color(139, 69, 19));
+                window.draw(smallRoof);
+            }
+        }
+        else
+        {
+            // Large city - castle/tower
+            // Tower base
+            sf::RectangleShape tower(sf::Vector2f(tileSize * 1.6f * scale, tileSize * 2.0f * scale));
+            tower.setPosition(sf::Vector2f(x - tileSize * 0.3f * scale, y - tileSize * 0.5f * scale));
+            tower.setFillColor(sf::Color(105, 105, 105)); // Dim gray stone
+            window.draw(tower);
+
+            // Tower top
+            sf::RectangleShape towerTop(sf::Vector2f(tileSize * 2.0f * scale, tileSize * 0.6f * scale));
+            towerTop.setPosition(sf::Vector2f(x - tileSize * 0.5f * scale, y - tileSize * 1.1f * scale));
+            towerTop.setFillColor(sf::Color(105, 105, 105));
+            window.draw(towerTop);
+
+            // Battlements
+            for (int i = 0; i < 4; i++)
+            {
+                sf::RectangleShape battlement(sf::Vector2f(tileSize * 0.3f * scale, tileSize * 0.4f * scale));
+                battlement.setPosition(sf::Vector2f(x - tileSize * 0.4f * scale + i * tileSize * 0.5f * scale, y - tileSize * 1.5f * scale));
+                battlement.setFillColor(sf::Color(105, 105, 105));
+                window.draw(battlement);
+            }
+
+            // Flag (for capital or large cities)
+            if (city->population > 10000)
+            {
+                // Flag pole
+                sf::RectangleShape pole(sf::Vector2f(4, tileSize * 1.2f * scale));
+                pole.setPosition(sf::Vector2f(x + tileSize * 0.9f * scale, y - tileSize * 2.0f * scale));
+                pole.setFillColor(sf::Color(101, 67, 33));
+                window.draw(pole);
+
+                // Flag
+                sf::ConvexShape flag;
+                flag.setPointCount(3);
+                flag.setPoint(0, sf::Vector2f(x + tileSize * 0.9f * scale + 4, y - tileSize * 2.0f * scale));
+                flag.setPoint(1, sf::Vector2f(x + tileSize * 0.9f * scale + tileSize * 0.6f, y - tileSize * 1.6f * scale));
+                flag.setPoint(2, sf::Vector2f(x + tileSize * 0.9f * scale + 4, y - tileSize * 1.2f * scale));
+                flag.setFillColor(sf::Color(220, 20, 60)); // Crimson
+                window.draw(flag);
+            }
+        }
+
+        // City name label (optional - comment out if too cluttered)
+        // Would need font support in SFML 3.0
+    }
+}
+
+void CivilizationSystem::renderTerritory(sf::RenderWindow &window, int tileSize)
+{
+    // Color palette for different civilizations
+    std::vector<sf::Color> territoryColors = {
+        sf::Color(255, 0, 0, 100),   // Red
+        sf::Color(0, 0, 255, 100),   // Blue
+        sf::Color(0, 255, 0, 100),   // Green
+        sf::Color(255, 255, 0, 100), // Yellow
+        sf::Color(255, 0, 255, 100), // Magenta
+        sf::Color(0, 255, 255, 100), // Cyan
+        sf::Color(255, 128, 0, 100), // Orange
+        sf::Color(128, 0, 255, 100), // Purple
+    };
+
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+    int index = 0;
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int territory = territoryMap(x, y);
+            if (territory >= 0)
+            {
+                sf::Color color = territoryColors[territory % territoryColors.size()];
+
+                float left = x * tileSize;
+                float top = y * tileSize;
+                float right = left + tileSize;
+                float bottom = top + tileSize;
+
+                // Create triangles
+                vertices[index + 0].position = sf::Vector2f(left, top);
+                vertices[index + 1].position = sf::Vector2f(right, top);
+                vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+                vertices[index + 3].position = sf::Vector2f(right, top);
+                vertices[index + 4].position = sf::Vector2f(right, bottom);
+                vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+                for (int i = 0; i < 6; i++)
+                {
+                    vertices[index + i].color = color;
+                }
+
+                index += 6;
+            }
+            else
+            {
+                index += 6;
+            }
+        }
+    }
+
+    vertices.resize(index);
+    window.draw(vertices);
+}
+
+void CivilizationSystem::renderDevelopment(sf::RenderWindow &window, int tileSize)
+{
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int index = (y * width + x) * 6;
+
+            float development = developmentMap(x, y);
+            if (development > 0.01f)
+            {
+                // Yellow to red gradient for development
+                int red = 255;
+                int green = 255 * (1.0f - development);
+                sf::Color color(red, green, 0, 150);
+
+                float left = x * tileSize;
+                float top = y * tileSize;
+                float right = left + tileSize;
+                float bottom = top + tileSize;
+
+                // Create triangles
+                vertices[index + 0].position = sf::Vector2f(left, top);
+                vertices[index + 1].position = sf::Vector2f(right, top);
+                vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+                vertices[index + 3].position = sf::Vector2f(right, top);
+                vertices[index + 4].position = sf::Vector2f(right, bottom);
+                vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+                for (int i = 0; i < 6; i++)
+                {
+                    vertices[index + i].color = color;
+                }
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
\ No newline at end of file
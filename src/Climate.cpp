@@ -1,385 +1,698 @@
 #include "Climate.h"
 #include "World.h"
+#include "Parallel.h"
 #include <cmath>
 #include <algorithm>
-#include <queue>
+#include <limits>
 #include <iostream>
 
-ClimateSystem::ClimateSystem(int width, int height) : width(width), height(height)
-{
-    temperatureMap.resize(height, std::vector<float>(width, 0.0f));
-    moistureMap.resize(height, std::vector<float>(width, 0.0f));
-    biomeMap.resize(height, std::vector<BiomeType>(width, BiomeType::OCEAN));
-}
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GENESIS_CLIMATE_AVX2
+#endif
 
-void ClimateSystem::generateClimate(World &world)
+namespace
 {
-    std::cout << "Generating climate..." << std::endl;
+    // Columns per task in the vertical distance pass, which sweeps its columns a row at a time
+    const int COLUMN_BAND = 64;
 
-    for (int y = 0; y < height; y++)
+    // Rows swept side by side by the wind pass, one per vector lane
+    const int WIND_LANES = 8;
+
+    // Cells per block in the portable biome pass
+    const int CLASSIFY_BLOCK = 64;
+
+    // Exact Euclidean distance from every cell to the nearest nonzero cell of sources, in two
+    // separable passes (Meijster et al.): each column's distance to the nearest source in that
+    // column, then along each row the lower envelope of the parabolas (x - q)^2 + g(q)^2 those
+    // column distances define. O(W*H) overall; infinity where there is no source at all.
+    void distanceTransform(const Grid2D<uint8_t> &sources, Grid2D<float> &distance)
     {
-        float latitude = (float)y / height;
+        const int width = sources.getWidth();
+        const int height = sources.getHeight();
+        const int infinity = width + height; // beyond any distance on the map
+        Grid2D<int> columnDistance(width, height);
 
-        for (int x = 0; x < width; x++)
+        auto columnBand = [&](int x0, int x1, int)
         {
-            float elevation = world.getElevation(x, y);
-            temperatureMap[y][x] = calculateTemperature(elevation, latitude);
-        }
+            const uint8_t *top = sources.row(0);
+            int *first = columnDistance.row(0);
+            for (int x = x0; x < x1; x++)
+            {
+                first[x] = top[x] ? 0 : infinity;
+            }
+            for (int y = 1; y < height; y++)
+            {
+                const uint8_t *source = sources.row(y);
+                const int *above = columnDistance.row(y - 1);
+                int *g = columnDistance.row(y);
+                for (int x = x0; x < x1; x++)
+                {
+                    g[x] = source[x] ? 0 : std::min(infinity, above[x] + 1);
+                }
+            }
+            for (int y = height - 2; y >= 0; y--)
+            {
+                const int *below = columnDistance.row(y + 1);
+                int *g = columnDistance.row(y);
+                for (int x = x0; x < x1; x++)
+                {
+                    g[x] = std::min(g[x], below[x] + 1);
+                }
+            }
+        };
+        Parallel::forEachChunk(width, COLUMN_BAND, columnBand);
+
+        distance.resize(width, height, 0.0f);
+        const long long unreachable = (long long)infinity * infinity;
+        auto rowBand = [&](int y0, int y1, int)
+        {
+            std::vector<int> vertices(width);
+            std::vector<double> boundaries(width + 1);
+            for (int y = y0; y < y1; y++)
+            {
+                const int *g = columnDistance.row(y);
+                auto height2 = [&](int q) { return (long long)g[q] * g[q] + (long long)q * q; };
+
+                // Parabola vertices[i] is lowest on [boundaries[i], boundaries[i + 1])
+                int k = 0;
+                vertices[0] = 0;
+                boundaries[0] = -std::numeric_limits<double>::infinity();
+                boundaries[1] = std::numeric_limits<double>::infinity();
+                for (int q = 1; q < width; q++)
+                {
+                    double s = (double)(height2(q) - height2(vertices[k])) / (2.0 * (q - vertices[k]));
+                    while (s <= boundaries[k])
+                    {
+                        k--;
+                        s = (double)(height2(q) - height2(vertices[k])) / (2.0 * (q - vertices[k]));
+                    }
+                    k++;
+                    vertices[k] = q;
+                    boundaries[k] = s;
+                    boundaries[k + 1] = std::numeric_limits<double>::infinity();
+                }
+
+                float *out = distance.row(y);
+                k = 0;
+                for (int x = 0; x < width; x++)
+                {
+                    while (boundaries[k + 1] < x)
+                        k++;
+                    const long long dx = x - vertices[k];
+                    const long long squared = dx * dx + (long long)g[vertices[k]] * g[vertices[k]];
+                    out[x] = squared >= unreachable ? std::numeric_limits<float>::infinity() : (float)std::sqrt((double)squared);
+                }
+            }
+        };
+        Parallel::forEachChunk(height, Parallel::ROW_BAND, rowBand);
     }
+}
+
+ClimateSystem::ClimateSystem(int width, int height) : width(width), height(height), latitudeWorldHeight(height)
+{
+    temperatureMap.resize(width, height, 0.0f);
+    moistureMap.resize(width, height, 0.0f);
+    biomeMap.resize(width, height, BiomeType::OCEAN);
+    setBiomeRules(getDefaultBiomeRules());
+}
+
+void ClimateSystem::generateClimate(World &world)
+{
+    if (verbose)
+        std::cout << "Generating climate..." << std::endl;
 
-    for (int y = 0; y < height; y++)
+    // Drainage for the whole map, then the distance to the sea and to rivers and lakes.
+    // A water cell is its own nearest water, so its moisture is 1; only land needs its distance.
+    if (drainage)
+        hydrology.run(world.getElevationMap());
+    else
+        hydrology.clear(width, height);
+    computeWaterDistance(world);
+    computeFreshwaterDistance();
+    if (moistureModel == MoistureModel::WIND)
     {
-        for (int x = 0; x < width; x++)
-        {
-            moistureMap[y][x] = calculateMoisture(world, x, y);
-        }
+        windMoistureMap.resize(width, height, 0.0f);
+        sweepWind(world, 0, height);
+    }
+    moistureMap.fill(1.0f);
+    for (uint32_t cell : world.getLandIndex().cells)
+    {
+        moistureMap[cell] = calculateMoisture(world, (int)(cell % width), (int)(cell / width));
     }
 
-    smoothMoisture();
-    smoothMoisture();
+    for (int pass = 0; pass < moistureSmoothingPasses; pass++)
+    {
+        smoothMoisture(moistureMap, 0, 0);
+    }
 
-    for (int y = 0; y < height; y++)
+    auto classifyBand = [&](int y0, int y1, int)
     {
-        for (int x = 0; x < width; x++)
+        for (int y = y0; y < y1; y++)
         {
-            float elevation = world.getElevation(x, y);
-            float temperature = temperatureMap[y][x];
-            float moisture = moistureMap[y][x];
-
-            biomeMap[y][x] = determineBiome(elevation, temperature, moisture);
+            classifyRow(world, y, 0, width);
         }
-    }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, classifyBand);
 
-    std::cout << "Climate generation complete!" << std::endl;
+    if (verbose)
+        std::cout << "Climate generation complete!" << std::endl;
 }
 
-float ClimateSystem::calculateTemperature(float elevation, float latitude)
+GridRect ClimateSystem::updateRegion(World &world, const GridRect &dirty)
 {
-    float latitudeEffect = std::abs(latitude - 0.5f) * 2.0f;
-    float baseTemp = baseTemperature - (latitudeTemperatureRange * latitudeEffect);
-
-    float elevationInMeters = std::max(0.0f, elevation * 2000.0f);
-    float tempDrop = (elevationInMeters / 1000.0f) * temperatureLapseRate;
+    if (dirty.clipped(width, height).isEmpty())
+        return GridRect();
 
-    return baseTemp - tempDrop;
-}
+    // Without a drainage map to keep there is nothing to update
+    if (hydrology.getWaterMap().getWidth() != width || hydrology.getWaterMap().getHeight() != height)
+    {
+        generateClimate(world);
+        return GridRect(0, 0, width, height);
+    }
 
-float ClimateSystem::calculateMoisture(const World &world, int x, int y)
-{
-    const int searchRadius = 20;
-    float minDistance = searchRadius;
+    GridRect changed = dirty.expanded(getInfluenceRadius()).clipped(width, height);
 
-    for (int dy = -searchRadius; dy <= searchRadius; dy++)
+    // The distance field only depends on which cells are water, which erosion rarely changes.
+    // Moisture reads it no further than the search radius, and only distances up to that radius
+    // can change outside the dirty rectangle, so it is enough to redo those around it.
+    const GridRect area = dirty.clipped(width, height);
+    bool coastChanged = false;
+    for (int y = area.y0; y < area.y1 && !coastChanged; y++)
     {
-        for (int dx = -searchRadius; dx <= searchRadius; dx++)
+        for (int x = area.x0; x < area.x1; x++)
         {
-            int nx = x + dx;
-            int ny = y + dy;
-
-            if (nx >= 0 && nx < width && ny >= 0 && ny < height)
+            if ((world.getElevation(x, y) < 0.0f) != (waterDistanceMap(x, y) == 0.0f))
             {
-                if (world.getElevation(nx, ny) < 0.0f)
-                {
-                    float distance = std::sqrt(dx * dx + dy * dy);
-                    minDistance = std::min(minDistance, distance);
-                }
+                coastChanged = true;
+                break;
             }
         }
     }
+    if (coastChanged)
+    {
+        computeWaterDistance(world, area.expanded(moistureSearchRadius).clipped(width, height));
+    }
 
-    float moisture = 1.0f - (minDistance / searchRadius);
+    // Under the wind model new ground changes its rows all the way downwind, and nothing else
+    if (moistureModel == MoistureModel::WIND)
+    {
+        sweepWind(world, area.y0, area.y1);
+        changed = GridRect(0, area.y0, width, area.y1).expanded(moistureSmoothingPasses * moistureSmoothingRadius).clipped(width, height);
+    }
 
-    float elevation = world.getElevation(x, y);
-    if (elevation > 0.5f)
+    // Every smoothing pass reads radius cells further out, so start from raw moisture over a wider
+    // window; smoothing gives cells whose box lies inside the window the same values as the full map
+    const GridRect window = changed.expanded(moistureSmoothingPasses * moistureSmoothingRadius).clipped(width, height);
+    const Grid2D<TerrainType> &terrain = world.getTerrainMap();
+    Grid2D<float> moisture(window.getWidth(), window.getHeight());
+    for (int y = window.y0; y < window.y1; y++)
     {
-        moisture *= (1.0f - (elevation - 0.5f));
+        for (int x = window.x0; x < window.x1; x++)
+        {
+            moisture(x - window.x0, y - window.y0) = terrain(x, y) >= TerrainType::SAND ? calculateMoisture(world, x, y) : 1.0f;
+        }
     }
 
-    return std::max(0.0f, std::min(1.0f, moisture));
+    for (int pass = 0; pass < moistureSmoothingPasses; pass++)
+    {
+        smoothMoisture(moisture, window.x0, window.y0);
+    }
+
+    for (int y = changed.y0; y < changed.y1; y++)
+    {
+        for (int x = changed.x0; x < changed.x1; x++)
+        {
+            moistureMap(x, y) = moisture(x - window.x0, y - window.y0);
+        }
+        classifyRow(world, y, changed.x0, changed.x1);
+    }
+
+    return changed;
 }
 
-void ClimateSystem::smoothMoisture()
+void ClimateSystem::setLatitudeFrame(int originY, int worldHeight)
 {
-    std::vector<std::vector<float>> newMoisture = moistureMap;
+    latitudeOriginY = originY;
+    latitudeWorldHeight = worldHeight;
+}
 
-    for (int y = 1; y < height - 1; y++)
+void ClimateSystem::computeWaterDistance(const World &world)
+{
+    const Grid2D<float> &elevation = world.getElevationMap();
+    Grid2D<uint8_t> sea(width, height);
+    for (size_t i = 0; i < sea.size(); i++)
     {
-        for (int x = 1; x < width - 1; x++)
-        {
-            float sum = 0.0f;
-            int count = 0;
+        sea[i] = elevation[i] < 0.0f;
+    }
+    distanceTransform(sea, waterDistanceMap);
+}
 
-            for (int dy = -1; dy <= 1; dy++)
-            {
-                for (int dx = -1; dx <= 1; dx++)
-                {
-                    sum += moistureMap[y + dy][x + dx];
-                    count++;
-                }
-            }
-            newMoisture[y][x] = sum / count;
+void ClimateSystem::computeWaterDistance(const World &world, const GridRect &area)
+{
+    // A distance within the search radius comes from a sea cell at most that far outside area
+    const GridRect source = area.expanded(moistureSearchRadius).clipped(width, height);
+    const Grid2D<float> &elevation = world.getElevationMap();
+    Grid2D<uint8_t> sea(source.getWidth(), source.getHeight());
+    for (int y = source.y0; y < source.y1; y++)
+    {
+        for (int x = source.x0; x < source.x1; x++)
+        {
+            sea(x - source.x0, y - source.y0) = elevation(x, y) < 0.0f;
         }
     }
 
-    moistureMap = newMoisture;
+    Grid2D<float> distance;
+    distanceTransform(sea, distance);
+    for (int y = area.y0; y < area.y1; y++)
+    {
+        for (int x = area.x0; x < area.x1; x++)
+        {
+            waterDistanceMap(x, y) = distance(x - source.x0, y - source.y0);
+        }
+    }
 }
 
-void ClimateSystem::generateRivers(World &world)
+void ClimateSystem::computeFreshwaterDistance()
 {
-    const int numRivers = 20;
-
-    for (int i = 0; i < numRivers; i++)
+    const Grid2D<Hydrology::Water> &water = hydrology.getWaterMap();
+    Grid2D<uint8_t> freshwater(width, height);
+    for (size_t i = 0; i < freshwater.size(); i++)
     {
-        int startX = rand() % width;
-        int startY = rand() % height;
-
-        if (world.getElevation(startX, startY) < 0.4f)
-            continue;
+        freshwater[i] = water[i] == Hydrology::Water::LAKE || water[i] == Hydrology::Water::RIVER;
+    }
+    distanceTransform(freshwater, freshwaterDistanceMap);
+}
 
-        int x = startX;
-        int y = startY;
-        int riverLength = 0;
-        const int maxLength = 100;
+// Moisture carried across the map by the prevailing wind of each row: easterly trade winds within
+// a third of the way from the equator to the poles, westerlies in the middle third, polar easterlies
+// beyond. Air enters saturated from the sea beyond the map edge. Rows are independent, so
+// WIND_LANES rows are swept together, one per vector lane: each group's elevation is first
+// transposed into a buffer ordered by step along the wind, making every step one vector.
+void ClimateSystem::sweepWind(const World &world, int y0, int y1)
+{
+    const Grid2D<float> &elevation = world.getElevationMap();
 
-        while (riverLength < maxLength)
+    auto windBand = [&](int b0, int b1, int)
+    {
+        std::vector<float> along((size_t)width * WIND_LANES);
+        std::vector<float> result((size_t)width * WIND_LANES);
+        for (int group = y0 + b0; group < y0 + b1; group += WIND_LANES)
         {
-            int lowestX = x;
-            int lowestY = y;
-            float lowestElev = world.getElevation(x, y);
-
-            for (int dy = -1; dy <= 1; dy++)
+            // Lanes past the last row repeat it, and their results are dropped
+            const int lanes = std::min(WIND_LANES, y0 + b1 - group);
+            int rows[WIND_LANES];
+            bool eastward[WIND_LANES];
+            for (int lane = 0; lane < WIND_LANES; lane++)
             {
-                for (int dx = -1; dx <= 1; dx++)
-                {
-                    if (dx == 0 && dy == 0)
-                        continue;
-
-                    int nx = x + dx;
-                    int ny = y + dy;
+                rows[lane] = group + std::min(lane, lanes - 1);
+                const float latitude = (float)(latitudeOriginY + rows[lane]) / latitudeWorldHeight;
+                const float fromEquator = std::abs(latitude - 0.5f) * 2.0f;
+                eastward[lane] = fromEquator >= 1.0f / 3.0f && fromEquator < 2.0f / 3.0f;
 
-                    if (nx > 0 && nx < width && ny > 0 && ny < height)
-                    {
-                        float elev = world.getElevation(nx, ny);
-                        if (elev < lowestElev)
-                        {
-                            lowestElev = elev;
-                            lowestX = nx;
-                            lowestY = ny;
-                        }
-                    }
+                const float *row = elevation.row(rows[lane]);
+                for (int step = 0; step < width; step++)
+                {
+                    along[(size_t)step * WIND_LANES + lane] = row[eastward[lane] ? step : width - 1 - step];
                 }
             }
 
-            if (lowestX == x && lowestY == y)
-                break;
-            if (lowestElev < 0.0f)
-                break;
-
-            x = lowestX;
-            y = lowestY;
-
-            moistureMap[y][x] = std::min(1.0f, moistureMap[y][x] + 0.5f);
-
-            for (int dy = -2; dy <= 2; dy++)
+            int step = 0;
+#if defined(GENESIS_CLIMATE_AVX2)
+            // Same operations in the same order as the scalar loop below
             {
-                for (int dx = -2; dx <= 2; dx++)
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 evaporation = _mm256_set1_ps(windEvaporation);
+                const __m256 landRain = _mm256_set1_ps(windLandRain);
+                const __m256 orographicRain = _mm256_set1_ps(windOrographicRain);
+                const __m256 rainWeight = _mm256_set1_ps(windRainWeight);
+                __m256 vapour = one;
+                __m256 previous = _mm256_loadu_ps(along.data());
+                for (; step < width; step++)
                 {
-                    int nx = x + dx;
-                    int ny = y + dy;
-
-                    if (nx >= 0 && nx < width && ny >= 0 && ny < height)
+                    const __m256 ground = _mm256_loadu_ps(along.data() + (size_t)step * WIND_LANES);
+                    const __m256 water = _mm256_cmp_ps(ground, zero, _CMP_LT_OQ);
+                    const __m256 wet = _mm256_add_ps(vapour, _mm256_mul_ps(evaporation, _mm256_sub_ps(one, vapour)));
+                    const __m256 rise = _mm256_max_ps(_mm256_sub_ps(ground, _mm256_max_ps(previous, zero)), zero);
+                    const __m256 rate = _mm256_min_ps(_mm256_add_ps(landRain, _mm256_mul_ps(orographicRain, rise)), one);
+                    __m256 rain = _mm256_mul_ps(vapour, rate);
+                    const __m256 dried = _mm256_sub_ps(vapour, rain);
+                    vapour = _mm256_blendv_ps(dried, wet, water);
+                    rain = _mm256_andnot_ps(water, rain);
+                    _mm256_storeu_ps(result.data() + (size_t)step * WIND_LANES,
+                                     _mm256_min_ps(_mm256_add_ps(vapour, _mm256_mul_ps(rainWeight, rain)), one));
+                    previous = ground;
+                }
+            }
+#endif
+            if (step < width)
+            {
+                float vapour[WIND_LANES];
+                float previous[WIND_LANES];
+                for (int lane = 0; lane < WIND_LANES; lane++)
+                {
+                    vapour[lane] = 1.0f;
+                    previous[lane] = along[lane];
+                }
+                for (; step < width; step++)
+                {
+                    const float *ground = along.data() + (size_t)step * WIND_LANES;
+                    float *out = result.data() + (size_t)step * WIND_LANES;
+                    for (int lane = 0; lane < WIND_LANES; lane++)
                     {
-                        float distance = std::sqrt(dx * dx + dy * dy);
-                        float moistureBonus = 0.3f * (1.0f - distance / 2.0f);
-                        moistureMap[ny][nx] = std::min(1.0f, moistureMap[ny][nx] + moistureBonus);
+                        const bool water = ground[lane] < 0.0f;
+                        const float wet = vapour[lane] + windEvaporation * (1.0f - vapour[lane]);
+                        const float rise = std::max(0.0f, ground[lane] - std::max(0.0f, previous[lane]));
+                        const float rate = std::min(1.0f, windLandRain + windOrographicRain * rise);
+                        float rain = vapour[lane] * rate;
+                        const float dried = vapour[lane] - rain;
+                        vapour[lane] = water ? wet : dried;
+                        rain = water ? 0.0f : rain;
+                        out[lane] = std::min(1.0f, vapour[lane] + windRainWeight * rain);
+                        previous[lane] = ground[lane];
                     }
                 }
             }
 
-            riverLength++;
+            for (int lane = 0; lane < lanes; lane++)
+            {
+                float *row = windMoistureMap.row(rows[lane]);
+                for (int step = 0; step < width; step++)
+                {
+                    row[eastward[lane] ? step : width - 1 - step] = result[(size_t)step * WIND_LANES + lane];
+                }
+            }
         }
-    }
+    };
+    Parallel::forEachChunk(y1 - y0, Parallel::ROW_BAND, windBand);
 }
 
-BiomeType ClimateSystem::determineBiome(float elevation, float temperature, float moisture)
+// Moisture comes from the wind sweep or falls off linearly with the distance to the sea. It rises
+// near rivers and lakes, and drops on high ground.
+float ClimateSystem::calculateMoisture(const World &world, int x, int y)
 {
-    if (elevation < -0.1f)
-        return BiomeType::OCEAN;
-    if (elevation < 0.0f)
-        return BiomeType::BEACH;
-
-    if (temperature < -5.0f)
-        return BiomeType::ICE;
-
-    if (temperature < 0.0f)
+    float moisture;
+    if (moistureModel == MoistureModel::WIND)
     {
-        return BiomeType::TUNDRA;
+        moisture = windMoistureMap(x, y);
     }
-    else if (temperature < 10.0f)
+    else
     {
-        if (moisture > 0.5f)
-            return BiomeType::TAIGA;
-        else
-            return BiomeType::TUNDRA;
+        const int searchRadius = moistureSearchRadius;
+        float minDistance = std::min((float)searchRadius, waterDistanceMap(x, y));
+        moisture = 1.0f - (minDistance / searchRadius);
     }
-    else if (temperature < 20.0f)
-    {
-        if (moisture > 0.6f)
-            return BiomeType::TEMPERATE_FOREST;
-        else if (moisture > 0.3f)
-            return BiomeType::TEMPERATE_GRASSLAND;
-        else
-            return BiomeType::DESERT;
+
+    const float freshwaterDistance = freshwaterDistanceMap(x, y);
+    if (freshwaterDistance < freshwaterReach)
+    {
+        moisture += freshwaterMoisture * (1.0f - freshwaterDistance / freshwaterReach);
     }
-    else
+
+    float cellElevation = world.getElevationMap()(x, y);
+    if (cellElevation > 0.5f)
     {
-        if (moisture > 0.7f)
-            return BiomeType::TROPICAL_FOREST;
-        else if (moisture > 0.3f)
-            return BiomeType::SAVANNA;
-        else
-            return BiomeType::DESERT;
+        moisture *= (1.0f - (cellElevation - 0.5f));
     }
+
+    return std::max(0.0f, std::min(1.0f, moisture));
 }
 
-void ClimateSystem::render(sf::RenderWindow &window, int tileSize)
+// One box blur pass of half-width moistureSmoothingRadius over a buffer holding the map cells from
+// (originX, originY) on. Each box averages the map cells it covers, so near the map edge it
+// shrinks. The blur is separable: a running sum along each row, then running column sums over a
+// ring of the last 2r+1 row sums. That makes the pass in place and its cost independent of the
+// radius. Sums are kept in 2^-24 fixed point, where running sums are exact, so a cell whose box
+// lies inside the buffer gets the same value however the buffer was cut from the map.
+void ClimateSystem::smoothMoisture(Grid2D<float> &moisture, int originX, int originY) const
 {
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+    const int radius = moistureSmoothingRadius;
+    const int bufferWidth = moisture.getWidth();
+    const int bufferHeight = moisture.getHeight();
+    const double scale = 16777216.0;
+    const int ringRows = 2 * radius + 1;
+
+    std::vector<int64_t> ring((size_t)ringRows * bufferWidth);
+    std::vector<int64_t> columnSum(bufferWidth, 0);
+    std::vector<int64_t> quantized(bufferWidth);
+    std::vector<double> columnCells(bufferWidth); // map columns each box spans
+    for (int x = 0; x < bufferWidth; x++)
+    {
+        const int mapX = originX + x;
+        columnCells[x] = std::min(width - 1, mapX + radius) - std::max(0, mapX - radius) + 1;
+    }
 
-    for (int y = 0; y < height; y++)
+    auto ringRow = [&](int y) { return ring.data() + (size_t)(y % ringRows) * bufferWidth; };
+    auto sumRow = [&](int y, int64_t *sums)
     {
-        for (int x = 0; x < width; x++)
+        const float *row = moisture.row(y);
+        for (int x = 0; x < bufferWidth; x++)
         {
-            int index = (y * width + x) * 6;
-
-            float left = x * tileSize;
-            float top = y * tileSize;
-            float right = left + tileSize;
-            float bottom = top + tileSize;
-
-            sf::Color color = BiomeColor::getColor(biomeMap[y][x]);
+            quantized[x] = (int64_t)((double)row[x] * scale + 0.5);
+        }
+        int64_t sum = 0;
+        for (int x = 0; x <= std::min(radius, bufferWidth - 1); x++)
+        {
+            sum += quantized[x];
+        }
+        for (int x = 0; x < bufferWidth; x++)
+        {
+            sums[x] = sum;
+            if (x + radius + 1 < bufferWidth)
+                sum += quantized[x + radius + 1];
+            if (x - radius >= 0)
+                sum -= quantized[x - radius];
+        }
+    };
 
-            vertices[index + 0].position = sf::Vector2f(left, top);
-            vertices[index + 1].position = sf::Vector2f(right, top);
-            vertices[index + 2].position = sf::Vector2f(left, bottom);
+    for (int y = 0; y <= std::min(radius, bufferHeight - 1); y++)
+    {
+        int64_t *sums = ringRow(y);
+        sumRow(y, sums);
+        for (int x = 0; x < bufferWidth; x++)
+        {
+            columnSum[x] += sums[x];
+        }
+    }
 
-            vertices[index + 3].position = sf::Vector2f(right, top);
-            vertices[index + 4].position = sf::Vector2f(right, bottom);
-            vertices[index + 5].position = sf::Vector2f(left, bottom);
+    for (int y = 0; y < bufferHeight; y++)
+    {
+        const int mapY = originY + y;
+        const double rowCells = std::min(height - 1, mapY + radius) - std::max(0, mapY - radius) + 1;
+        float *out = moisture.row(y);
+        for (int x = 0; x < bufferWidth; x++)
+        {
+            out[x] = (float)((double)columnSum[x] / (columnCells[x] * rowCells * scale));
+        }
 
-            for (int i = 0; i < 6; i++)
+        // Slide down a row: row y - radius leaves and row y + radius + 1 (not yet written) takes its slot
+        if (y - radius >= 0)
+        {
+            const int64_t *leaving = ringRow(y - radius);
+            for (int x = 0; x < bufferWidth; x++)
+            {
+                columnSum[x] -= leaving[x];
+            }
+        }
+        if (y + radius + 1 < bufferHeight)
+        {
+            int64_t *entering = ringRow(y + radius + 1);
+            sumRow(y + radius + 1, entering);
+            for (int x = 0; x < bufferWidth; x++)
             {
-                vertices[index + i].color = color;
+                columnSum[x] += entering[x];
             }
         }
     }
-
-    window.draw(vertices);
 }
 
-void ClimateSystem::renderTemperature(sf::RenderWindow &window, int tileSize)
+std::vector<BiomeRule> ClimateSystem::getDefaultBiomeRules()
 {
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+    const float any = std::numeric_limits<float>::infinity();
+    return {
+        {-5.0f, -any, BiomeType::ICE},
+        {0.0f, -any, BiomeType::TUNDRA},
+        {10.0f, 0.5f, BiomeType::TAIGA},
+        {10.0f, -any, BiomeType::TUNDRA},
+        {20.0f, 0.6f, BiomeType::TEMPERATE_FOREST},
+        {20.0f, 0.3f, BiomeType::TEMPERATE_GRASSLAND},
+        {20.0f, -any, BiomeType::DESERT},
+        {any, 0.7f, BiomeType::TROPICAL_FOREST},
+        {any, 0.3f, BiomeType::SAVANNA},
+        {any, -any, BiomeType::DESERT}};
+}
 
-    for (int y = 0; y < height; y++)
+bool ClimateSystem::setBiomeRules(const std::vector<BiomeRule> &rules)
+{
+    std::vector<float> temperatures;
+    std::vector<float> moistures;
+    for (const BiomeRule &rule : rules)
     {
-        for (int x = 0; x < width; x++)
-        {
-            int index = (y * width + x) * 6;
-
-            float left = x * tileSize;
-            float top = y * tileSize;
-            float right = left + tileSize;
-            float bottom = top + tileSize;
-
-            // Temperature to color (blue = cold, red = hot)
-            float temp = temperatureMap[y][x];
-            float normalized = (temp + 10.0f) / 40.0f; // Normalize -10 to 30 range
-            normalized = std::max(0.0f, std::min(1.0f, normalized));
+        if (std::isfinite(rule.temperatureBelow))
+            temperatures.push_back(rule.temperatureBelow);
+        if (std::isfinite(rule.moistureAbove))
+            moistures.push_back(rule.moistureAbove);
+    }
+    std::sort(temperatures.begin(), temperatures.end());
+    temperatures.erase(std::unique(temperatures.begin(), temperatures.end()), temperatures.end());
+    std::sort(moistures.begin(), moistures.end());
+    moistures.erase(std::unique(moistures.begin(), moistures.end()), moistures.end());
 
-            sf::Color color;
-            if (normalized < 0.5f)
-            {
-                // Cold: Blue to white
-                float t = normalized * 2.0f;
-                color.r = 50 + (205 * t);
-                color.g = 50 + (205 * t);
-                color.b = 255;
-            }
-            else
-            {
-                // Warm: White to red
-                float t = (normalized - 0.5f) * 2.0f;
-                color.r = 255;
-                color.g = 255 - (205 * t);
-                color.b = 255 - (205 * t);
-            }
+    if (rules.empty() || (int)temperatures.size() > BIOME_THRESHOLDS || (int)moistures.size() > BIOME_THRESHOLDS)
+    {
+        std::cerr << "Biome rules need at least one rule and at most " << BIOME_THRESHOLDS
+                  << " distinct thresholds per axis; keeping the current rules" << std::endl;
+        return false;
+    }
 
-            // Create triangles
-            vertices[index + 0].position = sf::Vector2f(left, top);
-            vertices[index + 1].position = sf::Vector2f(right, top);
-            vertices[index + 2].position = sf::Vector2f(left, bottom);
+    // Unused thresholds are never reached, so they only add classes no cell falls into
+    for (int k = 0; k < BIOME_THRESHOLDS; k++)
+    {
+        temperatureThresholds[k] = k < (int)temperatures.size() ? temperatures[k] : std::numeric_limits<float>::infinity();
+        moistureThresholds[k] = k < (int)moistures.size() ? moistures[k] : std::numeric_limits<float>::infinity();
+    }
+    biomeRules = rules;
+    compileBiomeTable();
+    return true;
+}
 
-            vertices[index + 3].position = sf::Vector2f(right, top);
-            vertices[index + 4].position = sf::Vector2f(right, bottom);
-            vertices[index + 5].position = sf::Vector2f(left, bottom);
+// Temperature class t covers [threshold t-1, threshold t), so "below threshold j" holds exactly for
+// t <= j; moisture class m covers (threshold m-1, threshold m], so "above threshold j" holds for
+// m > j. Each cell of the table is therefore decided without sampling a representative value.
+void ClimateSystem::compileBiomeTable()
+{
+    biomeTable[0] = (int32_t)BiomeType::OCEAN;
+    biomeTable[1] = (int32_t)BiomeType::BEACH;
+    biomeTable[2] = (int32_t)BiomeType::LAKE;
+    biomeTable[3] = (int32_t)BiomeType::RIVER;
 
-            for (int i = 0; i < 6; i++)
+    for (int t = 0; t < BIOME_CLASSES; t++)
+    {
+        for (int m = 0; m < BIOME_CLASSES; m++)
+        {
+            BiomeType biome = biomeRules.back().biome;
+            for (const BiomeRule &rule : biomeRules)
             {
-                vertices[index + i].color = color;
+                const int below = (int)(std::lower_bound(temperatureThresholds, temperatureThresholds + BIOME_THRESHOLDS, rule.temperatureBelow) - temperatureThresholds);
+                const int above = (int)(std::lower_bound(moistureThresholds, moistureThresholds + BIOME_THRESHOLDS, rule.moistureAbove) - moistureThresholds);
+                const bool cold = rule.temperatureBelow == std::numeric_limits<float>::infinity() ||
+                                  (std::isfinite(rule.temperatureBelow) && t <= below);
+                const bool wet = rule.moistureAbove == -std::numeric_limits<float>::infinity() ||
+                                 (std::isfinite(rule.moistureAbove) && m > above);
+                if (cold && wet)
+                {
+                    biome = rule.biome;
+                    break;
+                }
             }
+            biomeTable[BIOME_SLOTS + t * BIOME_CLASSES + m] = (int32_t)biome;
         }
     }
-
-    window.draw(vertices);
 }
 
-void ClimateSystem::renderMoisture(sf::RenderWindow &window, int tileSize)
+// Temperature and biome for cells [x0, x1) of row y. Rivers and lakes on land take precedence over
+// the climate biome, and the elevation cutoffs over both; all of it is picked with selects, so
+// each cell ends in one table lookup and the AVX2 path does eight with a gather.
+void ClimateSystem::classifyRow(const World &world, int y, int x0, int x1)
 {
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
-
-    for (int y = 0; y < height; y++)
+    const float latitude = (float)(latitudeOriginY + y) / latitudeWorldHeight;
+    const float latitudeEffect = std::abs(latitude - 0.5f) * 2.0f;
+    const float baseTemp = baseTemperature - (latitudeTemperatureRange * latitudeEffect);
+
+    const float *elevation = world.getElevationMap().row(y);
+    const Hydrology::Water *water = hydrology.getWaterMap().row(y);
+    const float *moisture = moistureMap.row(y);
+    float *temperature = temperatureMap.row(y);
+    BiomeType *biome = biomeMap.row(y);
+
+    int x = x0;
+#if defined(GENESIS_CLIMATE_AVX2)
+    const __m256 base = _mm256_set1_ps(baseTemp);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 metres = _mm256_set1_ps(2000.0f);
+    const __m256 kilometre = _mm256_set1_ps(1000.0f);
+    const __m256 lapseRate = _mm256_set1_ps(temperatureLapseRate);
+    const __m256 ocean = _mm256_set1_ps(oceanBelow);
+    const __m256 beach = _mm256_set1_ps(beachBelow);
+    const __m256i lake = _mm256_set1_epi32((int)Hydrology::Water::LAKE);
+    const __m256i river = _mm256_set1_epi32((int)Hydrology::Water::RIVER);
+    const __m256i classes = _mm256_set1_epi32(BIOME_CLASSES);
+    const __m256i slots = _mm256_set1_epi32(BIOME_SLOTS);
+    for (; x + 8 <= x1; x += 8)
+    {
+        const __m256 e = _mm256_loadu_ps(elevation + x);
+        const __m256 drop = _mm256_mul_ps(_mm256_div_ps(_mm256_max_ps(_mm256_mul_ps(e, metres), zero), kilometre), lapseRate);
+        const __m256 t = _mm256_sub_ps(base, drop);
+        const __m256 m = _mm256_loadu_ps(moisture + x);
+        _mm256_storeu_ps(temperature + x, t);
+
+        // A passed comparison is all ones, i.e. -1, so subtracting the masks counts them
+        __m256i tClass = _mm256_setzero_si256();
+        __m256i mClass = _mm256_setzero_si256();
+        for (int k = 0; k < BIOME_THRESHOLDS; k++)
+        {
+            tClass = _mm256_sub_epi32(tClass, _mm256_castps_si256(_mm256_cmp_ps(t, _mm256_set1_ps(temperatureThresholds[k]), _CMP_GE_OQ)));
+            mClass = _mm256_sub_epi32(mClass, _mm256_castps_si256(_mm256_cmp_ps(m, _mm256_set1_ps(moistureThresholds[k]), _CMP_GT_OQ)));
+        }
+        __m256i index = _mm256_add_epi32(slots, _mm256_add_epi32(_mm256_mullo_epi32(tClass, classes), mClass));
+
+        const __m256i w = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(water + x)));
+        index = _mm256_blendv_epi8(index, _mm256_set1_epi32(3), _mm256_cmpeq_epi32(w, river));
+        index = _mm256_blendv_epi8(index, _mm256_set1_epi32(2), _mm256_cmpeq_epi32(w, lake));
+        index = _mm256_blendv_epi8(index, _mm256_set1_epi32(1), _mm256_castps_si256(_mm256_cmp_ps(e, beach, _CMP_LT_OQ)));
+        index = _mm256_blendv_epi8(index, _mm256_setzero_si256(), _mm256_castps_si256(_mm256_cmp_ps(e, ocean, _CMP_LT_OQ)));
+        _mm256_storeu_si256((__m256i *)(biome + x), _mm256_i32gather_epi32((const int *)biomeTable, index, 4));
+    }
+#endif
+    // The same in short passes the compiler can vectorize one at a time. Locals, because the
+    // stores through the row pointers could otherwise alias the members.
+    float temperatureAt[BIOME_THRESHOLDS];
+    float moistureAt[BIOME_THRESHOLDS];
+    std::copy(temperatureThresholds, temperatureThresholds + BIOME_THRESHOLDS, temperatureAt);
+    std::copy(moistureThresholds, moistureThresholds + BIOME_THRESHOLDS, moistureAt);
+    const float lapse = temperatureLapseRate;
+    const float oceanLevel = oceanBelow;
+    const float beachLevel = beachBelow;
+    int32_t index[CLASSIFY_BLOCK];
+    for (; x < x1; x += CLASSIFY_BLOCK)
     {
-        for (int x = 0; x < width; x++)
+        const int count = std::min(CLASSIFY_BLOCK, x1 - x);
+        for (int i = 0; i < count; i++)
         {
-            int index = (y * width + x) * 6;
-
-            float left = x * tileSize;
-            float top = y * tileSize;
-            float right = left + tileSize;
-            float bottom = top + tileSize;
-
-            // Moisture to color (brown = dry, blue = wet)
-            float moisture = moistureMap[y][x];
-            sf::Color color;
-            color.r = 139 * (1.0f - moisture);
-            color.g = 90 * (1.0f - moisture) + 90 * moisture;
-            color.b = 50 + 205 * moisture;
-
-            // Create triangles
-            vertices[index + 0].position = sf::Vector2f(left, top);
-            vertices[index + 1].position = sf::Vector2f(right, top);
-            vertices[index + 2].position = sf::Vector2f(left, bottom);
-
-            vertices[index + 3].position = sf::Vector2f(right, top);
-            vertices[index + 4].position = sf::Vector2f(right, bottom);
-            vertices[index + 5].position = sf::Vector2f(left, bottom);
-
-            for (int i = 0; i < 6; i++)
+            const float elevationInMeters = std::max(0.0f, elevation[x + i] * 2000.0f);
+            temperature[x + i] = baseTemp - (elevationInMeters / 1000.0f) * lapse;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            int tClass = 0;
+            int mClass = 0;
+            for (int k = 0; k < BIOME_THRESHOLDS; k++)
             {
-                vertices[index + i].color = color;
+                tClass += (int)(temperature[x + i] >= temperatureAt[k]);
+                mClass += (int)(moisture[x + i] > moistureAt[k]);
             }
+            index[i] = BIOME_SLOTS + tClass * BIOME_CLASSES + mClass;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            const float e = elevation[x + i];
+            const int w = (int)water[x + i];
+            int cell = index[i];
+            cell = w == (int)Hydrology::Water::RIVER ? 3 : cell;
+            cell = w == (int)Hydrology::Water::LAKE ? 2 : cell;
+            cell = e < beachLevel ? 1 : cell;
+            cell = e < oceanLevel ? 0 : cell;
+            biome[x + i] = (BiomeType)biomeTable[cell];
         }
     }
-
-    window.draw(vertices);
 }
 
 float ClimateSystem::getTemperature(int x, int y) const
 {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        return temperatureMap[y][x];
+        return temperatureMap(x, y);
     }
     return 0.0f;
 }
@@ -388,7 +701,7 @@ float ClimateSystem::getMoisture(int x, int y) const
 {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        return moistureMap[y][x];
+        return moistureMap(x, y);
     }
     return 0.0f;
 }
@@ -397,7 +710,7 @@ BiomeType ClimateSystem::getBiome(int x, int y) const
 {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        return biomeMap[y][x];
+        return biomeMap(x, y);
     }
     return BiomeType::OCEAN;
 }
\ No newline at end of file
@@ -1,7 +1,15 @@
 #pragma once
 
 #include <vector>
-#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdint>
+#include "Grid2D.h"
+#include "Hydrology.h"
+
+namespace sf
+{
+    class RenderWindow;
+}
 
 class World;
 
@@ -21,40 +29,9 @@ enum class BiomeType
     RIVER
 };
 
-struct BiomeColor
+// Display names for reports and the viewer
+struct BiomeInfo
 {
-    static sf::Color getColor(BiomeType type)
-    {
-        switch (type)
-        {
-        case BiomeType::OCEAN:
-            return sf::Color(0, 50, 120);
-        case BiomeType::ICE:
-            return sf::Color(240, 248, 255);
-        case BiomeType::TUNDRA:
-            return sf::Color(196, 204, 187);
-        case BiomeType::TAIGA:
-            return sf::Color(0, 100, 0);
-        case BiomeType::TEMPERATE_FOREST:
-            return sf::Color(34, 139, 34);
-        case BiomeType::TEMPERATE_GRASSLAND:
-            return sf::Color(154, 205, 50);
-        case BiomeType::DESERT:
-            return sf::Color(238, 203, 173);
-        case BiomeType::SAVANNA:
-            return sf::Color(209, 186, 116);
-        case BiomeType::TROPICAL_FOREST:
-            return sf::Color(0, 128, 0);
-        case BiomeType::BEACH:
-            return sf::Color(238, 214, 175);
-        case BiomeType::LAKE:
-            return sf::Color(100, 149, 237);
-        case BiomeType::RIVER:
-            return sf::Color(65, 105, 225);
-        }
-        return sf::Color::Black;
-    }
-
     static const char *getName(BiomeType type)
     {
         switch (type)
@@ -88,30 +65,120 @@ struct BiomeColor
     }
 };
 
+// One line of the biome table: a land cell whose temperature is below temperatureBelow and whose
+// moisture is above moistureAbove gets biome. Use infinity / -infinity for "any".
+struct BiomeRule
+{
+    float temperatureBelow;
+    float moistureAbove;
+    BiomeType biome;
+};
+
 class ClimateSystem
 {
+public:
+    // WIND carries moisture in from the sea along the prevailing wind of each latitude band,
+    // raining it out where the ground rises, so ranges leave dry lee sides. DISTANCE makes
+    // moisture fall off with the distance to the sea alone.
+    enum class MoistureModel
+    {
+        WIND,
+        DISTANCE
+    };
+
 private:
     int width;
     int height;
 
-    std::vector<std::vector<float>> temperatureMap;
-    std::vector<std::vector<float>> moistureMap;
-    std::vector<std::vector<BiomeType>> biomeMap;
+    // Latitude is measured against the whole world when this system covers only a region of it
+    int latitudeOriginY = 0;
+    int latitudeWorldHeight;
+
+    Grid2D<float> temperatureMap;
+    Grid2D<float> moistureMap;
+    Grid2D<BiomeType> biomeMap;
+    Grid2D<float> waterDistanceMap;      // cells to the nearest sea cell, exact up to moistureSearchRadius
+    Grid2D<float> freshwaterDistanceMap; // cells to the nearest river or lake cell
+    Grid2D<float> windMoistureMap;       // WIND model moisture before rivers, lakes and smoothing
+    Hydrology hydrology;
 
     float baseTemperature = 20.0f;
     float temperatureLapseRate = 6.5f;
     float latitudeTemperatureRange = 30.0f;
 
-    float calculateTemperature(float elevation, float latitude);
+    MoistureModel moistureModel = MoistureModel::WIND;
+    int moistureSearchRadius = 20; // DISTANCE: moisture falls to 0 this far from water
+
+    // WIND: per cell along the wind, air over the sea takes up this fraction of its missing
+    // moisture, and air over land rains out landRain plus orographicRain per unit of rise.
+    // A cell's moisture is the air's moisture plus rainWeight times what fell there.
+    float windEvaporation = 0.1f;
+    float windLandRain = 0.008f;
+    float windOrographicRain = 4.0f;
+    float windRainWeight = 4.0f;
+    float freshwaterMoisture = 0.4f; // moisture a river or lake adds to its own cell
+    float freshwaterReach = 6.0f;    // falling to nothing this far away
+    bool drainage = true;            // run hydrology (rivers and lakes)
+    int moistureSmoothingPasses = 2;
+    int moistureSmoothingRadius = 1; // box half-width; the cost per pass does not depend on it
+    bool verbose = true;
+
+    // Biome classification. The rules are compiled into a table indexed by temperature class (how
+    // many of the rules' temperature thresholds a cell reaches) and moisture class (how many
+    // moisture thresholds it exceeds), after four fixed slots for ocean, beach, lake and river.
+    // Counting against a fixed number of padded thresholds makes every table cost the same.
+    static const int BIOME_THRESHOLDS = 8;
+    static const int BIOME_SLOTS = 4;
+    static const int BIOME_CLASSES = BIOME_THRESHOLDS + 1;
+    float oceanBelow = -0.1f; // elevation below which a cell is ocean
+    float beachBelow = 0.0f;  // and below which it is beach
+    std::vector<BiomeRule> biomeRules;
+    float temperatureThresholds[BIOME_THRESHOLDS];
+    float moistureThresholds[BIOME_THRESHOLDS];
+    int32_t biomeTable[BIOME_SLOTS + BIOME_CLASSES * BIOME_CLASSES];
+
+    void computeWaterDistance(const World &world);
+    void computeWaterDistance(const World &world, const GridRect &area);
+    void computeFreshwaterDistance();
+    void sweepWind(const World &world, int y0, int y1);
     float calculateMoisture(const World &world, int x, int y);
-    BiomeType determineBiome(float elevation, float temperature, float moisture);
-    void generateRivers(World &world);
-    void smoothMoisture();
+    void compileBiomeTable();
+    void classifyRow(const World &world, int y, int x0, int x1);
+    void smoothMoisture(Grid2D<float> &moisture, int originX, int originY) const;
 
 public:
     ClimateSystem(int width, int height);
 
     void generateClimate(World &world);
+
+    // Brings the maps up to date after elevation changed only inside dirty, recomputing just the
+    // cells within the influence radius of it. The result equals generateClimate() except that the
+    // rivers and lakes of the last generateClimate() are kept: drainage depends on whole basins, so
+    // only generateClimate() reruns hydrology. Returns the rectangle recomputed.
+    GridRect updateRegion(World &world, const GridRect &dirty);
+    void setLatitudeFrame(int originY, int worldHeight);
+    void setVerbose(bool enabled) { verbose = enabled; }
+    void setMoistureModel(MoistureModel model) { moistureModel = model; }
+    MoistureModel getMoistureModel() const { return moistureModel; }
+    // Rivers and lakes need whole drainage basins, so maps that only cover part of the world turn them off
+    void setDrainageEnabled(bool enabled) { drainage = enabled; }
+    void setMoistureSmoothing(int passes, int radius)
+    {
+        moistureSmoothingPasses = std::max(0, passes);
+        moistureSmoothingRadius = std::max(1, radius);
+    }
+
+    // Land biomes by temperature and moisture; the first matching rule wins, and cells no rule
+    // matches get the last rule's biome. At most BIOME_THRESHOLDS distinct finite thresholds per
+    // axis; a table with more is rejected. Applies from the next generateClimate() or updateRegion().
+    static std::vector<BiomeRule> getDefaultBiomeRules();
+    bool setBiomeRules(const std::vector<BiomeRule> &rules);
+    const std::vector<BiomeRule> &getBiomeRules() const { return biomeRules; }
+
+    // How far away a cell's climate can be affected by elevation under the DISTANCE model (WIND
+    // carries changes downwind to the map edge). A region generated with this much margin on
+    // every side matches the full map in its interior.
+    int getInfluenceRadius() const { return moistureSearchRadius + moistureSmoothingPasses * moistureSmoothingRadius; }
     void render(sf::RenderWindow &window, int tileSize);
     void renderTemperature(sf::RenderWindow &window, int tileSize);
     void renderMoisture(sf::RenderWindow &window, int tileSize);
@@ -120,4 +187,19 @@ public:
     float getTemperature(int x, int y) const;
     float getMoisture(int x, int y) const;
     BiomeType getBiome(int x, int y) const;
+
+    // Direct grid access for hot loops (no bounds checks)
+    const Grid2D<float> &getTemperatureMap() const { return temperatureMap; }
+    const Grid2D<float> &getMoistureMap() const { return moistureMap; }
+    const Grid2D<BiomeType> &getBiomeMap() const { return biomeMap; }
+
+    // Euclidean distance in cells from each cell to the nearest cell below sea level (0 on water,
+    // infinity if the map has none), as of the last generateClimate(). updateRegion() keeps the
+    // distances up to moistureSearchRadius exact; larger ones can be left stale.
+    const Grid2D<float> &getWaterDistanceMap() const { return waterDistanceMap; }
+
+    // Drainage (filled elevation, flow directions and accumulation, rivers and lakes) as of the
+    // last generateClimate()
+    Hydrology &getHydrology() { return hydrology; }
+    const Hydrology &getHydrology() const { return hydrology; }
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "Climate.h"
+#include "RenderColors.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+void ClimateSystem::render(sf::RenderWindow &window, int tileSize)
+{
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int index = (y * width + x) * 6;
+
+            float left = x * tileSize;
+            float top = y * tileSize;
+            float right = left + tileSize;
+            float bottom = top + tileSize;
+
+            sf::Color color = BiomeColor::getColor(biomeMap(x, y));
+
+            vertices[index + 0].position = sf::Vector2f(left, top);
+            vertices[index + 1].position = sf::Vector2f(right, top);
+            vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+            vertices[index + 3].position = sf::Vector2f(right, top);
+            vertices[index + 4].position = sf::Vector2f(right, bottom);
+            vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+            for (int i = 0; i < 6; i++)
+            {
+                vertices[index + i].color = color;
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
+
+void ClimateSystem::renderTemperature(sf::RenderWindow &window, int tileSize)
+{
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int index = (y * width + x) * 6;
+
+            float left = x * tileSize;
+            float top = y * tileSize;
+            float right = left + tileSize;
+            float bottom = top + tileSize;
+
+            // Temperature to color (blue = cold, red = hot)
+            float temp = temperatureMap(x, y);
+            float normalized = (temp + 10.0f) / 40.0f; // Normalize -10 to 30 range
+            normalized = std::max(0.0f, std::min(1.0f, normalized));
+
+            sf::Color color;
+            if (normalized < 0.5f)
+            {
+                // Cold: Blue to white
+                float t = normalized * 2.0f;
+                color.r = 50 + (205 * t);
+                color.g = 50 + (205 * t);
+                color.b = 255;
+            }
+            else
+            {
+                // Warm: White to red
+                float t = (normalized - 0.5f) * 2.0f;
+                color.r = 255;
+                color.g = 255 - (205 * t);
+                color.b = 255 - (205 * t);
+            }
+
+            // Create triangles
+            vertices[index + 0].position = sf::Vector2f(left, top);
+            vertices[index + 1].position = sf::Vector2f(right, top);
+            vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+            vertices[index + 3].position = sf::Vector2f(right, top);
+            vertices[index + 4].position = sf::Vector2f(right, bottom);
+            vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+            for (int i = 0; i < 6; i++)
+            {
+                vertices[index + i].color = color;
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
+
+void ClimateSystem::renderMoisture(sf::RenderWindow &window, int tileSize)
+{
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int index = (y * width + x) * 6;
+
+            float left = x * tileSize;
+            float top = y * tileSize;
+            float right = left + tileSize;
+            float bottom = top + tileSize;
+
+            // Moisture to color (brown = dry, blue = wet)
+            float moisture = moistureMap(x, y);
+            sf::Color color;
+            color.r = 139 * (1.0f - moisture);
+            color.g = 90 * (1.0f - moisture) + 90 * moisture;
+            color.b = 50 + 205 * moisture;
+
+            // Create triangles
+            vertices[index + 0].position = sf::Vector2f(left, top);
+            vertices[index + 1].position = sf::Vector2f(right, top);
+            vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+            vertices[index + 3].position = sf::Vector2f(right, top);
+            vertices[index + 4].position = sf::Vector2f(right, bottom);
+            vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+            for (int i = 0; i < 6; i++)
+            {
+                vertices[index + i].color = color;
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
\ No newline at end of file
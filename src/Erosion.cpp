@@ -1,10 +1,99 @@
 #include "Erosion.h"
 #include "World.h"
+#include "Parallel.h"
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <cstdint>
+#include "Random.h"
 
-ErosionSimulator::ErosionSimulator(unsigned int seed) : rng(seed), uniformDist(0.0f, 1.0f) {}
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GENESIS_EROSION_AVX2
+#endif
+
+// In-bounds equivalent of World::modifyElevation
+static inline void addClamped(float &cell, float delta)
+{
+    cell = std::max(-1.0f, std::min(1.0f, cell + delta));
+}
+
+namespace
+{
+    const int LANES = ErosionSimulator::DROPLET_BATCH;
+
+    // Height and gradient at (x[i], y[i]) for every live lane, with the same arithmetic as
+    // getHeightAndGradient. Lanes with alive[i] == 0 may hold any position and are not sampled.
+    void sampleBatch(const Grid2D<float> &map, const float *x, const float *y, const int32_t *alive,
+                     float *height, float *gradX, float *gradY)
+    {
+        const int mapWidth = map.getWidth();
+        const float *cells = map.data();
+
+#if defined(GENESIS_EROSION_AVX2)
+        static_assert(LANES == 8, "the AVX2 gathers cover eight lanes");
+        const __m256 px = _mm256_load_ps(x);
+        const __m256 py = _mm256_load_ps(y);
+        const __m256i cellX = _mm256_cvttps_epi32(px);
+        const __m256i cellY = _mm256_cvttps_epi32(py);
+        const __m256 u = _mm256_sub_ps(px, _mm256_cvtepi32_ps(cellX));
+        const __m256 v = _mm256_sub_ps(py, _mm256_cvtepi32_ps(cellY));
+
+        // Dead lanes gather cell 0 instead of following a position that may be off the map
+        __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(cellY, _mm256_set1_epi32(mapWidth)), cellX);
+        index = _mm256_and_si256(index, _mm256_load_si256((const __m256i *)alive));
+
+        const __m256 heightNW = _mm256_i32gather_ps(cells, index, 4);
+        const __m256 heightNE = _mm256_i32gather_ps(cells + 1, index, 4);
+        const __m256 heightSW = _mm256_i32gather_ps(cells + mapWidth, index, 4);
+        const __m256 heightSE = _mm256_i32gather_ps(cells + mapWidth + 1, index, 4);
+
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 oneMinusU = _mm256_sub_ps(one, u);
+        const __m256 oneMinusV = _mm256_sub_ps(one, v);
+
+        _mm256_store_ps(gradX, _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(heightNE, heightNW), oneMinusV),
+                                             _mm256_mul_ps(_mm256_sub_ps(heightSE, heightSW), v)));
+        _mm256_store_ps(gradY, _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(heightSW, heightNW), oneMinusU),
+                                             _mm256_mul_ps(_mm256_sub_ps(heightSE, heightNE), u)));
+
+        __m256 h = _mm256_mul_ps(_mm256_mul_ps(heightNW, oneMinusU), oneMinusV);
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_mul_ps(heightNE, u), oneMinusV));
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_mul_ps(heightSW, oneMinusU), v));
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_mul_ps(heightSE, u), v));
+        _mm256_store_ps(height, h);
+#else
+        for (int lane = 0; lane < LANES; lane++)
+        {
+            if (!alive[lane])
+                continue;
+
+            int cellX = (int)x[lane];
+            int cellY = (int)y[lane];
+            float u = x[lane] - cellX;
+            float v = y[lane] - cellY;
+
+            const float *row0 = cells + (size_t)cellY * mapWidth + cellX;
+            const float *row1 = row0 + mapWidth;
+
+            gradX[lane] = (row0[1] - row0[0]) * (1 - v) + (row1[1] - row1[0]) * v;
+            gradY[lane] = (row1[0] - row0[0]) * (1 - u) + (row1[1] - row0[1]) * u;
+            height[lane] = row0[0] * (1 - u) * (1 - v) + row0[1] * u * (1 - v) + row1[0] * (1 - u) * v + row1[1] * u * v;
+        }
+#endif
+    }
+}
+
+const char *ErosionSimulator::batchKernelName()
+{
+#if defined(GENESIS_EROSION_AVX2)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+ErosionSimulator::ErosionSimulator() {}
 
 void ErosionSimulator::erode(World &world, int numDroplets)
 {
@@ -13,50 +102,406 @@ void ErosionSimulator::erode(World &world, int numDroplets)
         numDroplets = params.numDroplets;
     }
 
+    if (engine == Engine::PIPE)
+    {
+        std::cout << "Starting pipe-model erosion with " << pipeErosion.getParameters().iterations << " iterations..." << std::endl;
+        pipeErosion.run(world.getElevationMap(), true);
+        std::cout << "Erosion simulation complete." << std::endl;
+        world.assignTerrainTypes();
+        return;
+    }
+
+    if (multiresolutionFactor > 1)
+    {
+        erodeMultiresolution(world, numDroplets);
+        return;
+    }
+
+    erodeDroplets(world, numDroplets);
+}
+
+std::vector<uint32_t> ErosionSimulator::getSpawnCells(const World &world, const GridRect &area)
+{
+    const int mapWidth = world.getWidth();
+    const GridRect spawnArea = area.clipped(mapWidth - 1, world.getHeight() - 1);
+
+    // The area's slice of every land index row
+    std::vector<uint32_t> cells;
+    const LandIndex &landIndex = world.getLandIndex();
+    for (int y = spawnArea.y0; y < spawnArea.y1; y++)
+    {
+        const uint32_t *rowBegin = landIndex.cells.data() + landIndex.rowStart[y];
+        const uint32_t *rowEnd = landIndex.cells.data() + landIndex.rowStart[y + 1];
+        cells.insert(cells.end(),
+                     std::lower_bound(rowBegin, rowEnd, (uint32_t)(y * mapWidth + spawnArea.x0)),
+                     std::lower_bound(rowBegin, rowEnd, (uint32_t)(y * mapWidth + spawnArea.x1)));
+    }
+    return cells;
+}
+
+GridRect ErosionSimulator::runLandDroplets(World &world, const std::vector<uint32_t> &landCells, unsigned int streamSeed,
+                                           uint64_t firstDroplet, int count)
+{
+    const int mapWidth = world.getWidth();
+    float startX[DROPLET_BATCH];
+    float startY[DROPLET_BATCH];
+    GridRect starts;
+    for (int i = 0; i < count; i++)
+    {
+        Random::Generator random(streamSeed, Random::Subsystem::EROSION_DROPLETS, firstDroplet + i);
+        const uint32_t cell = landCells[random.nextInt((int)landCells.size())];
+        startX[i] = (float)(cell % mapWidth) + random.nextFloat();
+        startY[i] = (float)(cell / mapWidth) + random.nextFloat();
+        starts.include((int)(cell % mapWidth), (int)(cell / mapWidth));
+    }
+
+    runDroplets(world, startX, startY, count);
+    return starts.isEmpty() ? starts : starts.expanded(getDropletReach()).clipped(mapWidth, world.getHeight());
+}
+
+void ErosionSimulator::erodeDroplets(World &world, int numDroplets)
+{
+    prepareBrush(world.getWidth());
+
+    // Droplets only start on land, so the whole budget does useful work
+    const std::vector<uint32_t> landCells = getSpawnCells(world, GridRect(0, 0, world.getWidth(), world.getHeight()));
+    if (landCells.empty())
+    {
+        std::cout << "No land to erode." << std::endl;
+        return;
+    }
+
+    if (schedule == Schedule::TILED)
+    {
+        erodeTiled(world, landCells, numDroplets);
+        return;
+    }
+
     std::cout << "Starting erosion simulation with " << numDroplets << " droplets..." << std::endl;
 
     int progressInterval = numDroplets / 10;
+    const uint64_t firstIndex = world.reserveDroplets(numDroplets);
 
-    for (int i = 0; i < numDroplets; i++)
+    for (int first = 0; first < numDroplets; first += DROPLET_BATCH)
     {
-        float startX = uniformDist(rng) * (world.getWidth() - 1);
-        float startY = uniformDist(rng) * (world.getHeight() - 1);
+        const int count = std::min(DROPLET_BATCH, numDroplets - first);
+        runLandDroplets(world, landCells, (uint32_t)world.getSeed(), firstIndex + first, count);
+
+        for (int i = first; i < first + count; i++)
+        {
+            if (progressInterval > 0 && i % progressInterval == 0)
+            {
+                std::cout << "Erosion progress: " << (i * 100 / numDroplets) << "%" << std::endl;
+            }
+        }
+    }
+
+    std::cout << "Erosion simulation complete." << std::endl;
 
-        if (world.getElevation((int)startX, (int)startY) < -0.1f)
+    world.assignTerrainTypes();
+}
+
+// Carves the large drainage structure on a copy shrunk by multiresolutionFactor, where one droplet
+// covers factor^2 cells at the cost of one, then adds back the upsampled height change and runs a
+// shorter full-resolution pass for the detail
+void ErosionSimulator::erodeMultiresolution(World &world, int numDroplets)
+{
+    const int factor = multiresolutionFactor;
+    const int mapWidth = world.getWidth();
+    const int mapHeight = world.getHeight();
+    const int coarseWidth = std::max(2, (mapWidth + factor - 1) / factor);
+    const int coarseHeight = std::max(2, (mapHeight + factor - 1) / factor);
+    // Slopes per cell are factor times steeper on the coarse map, so each droplet there carries more;
+    // the extra 1/sqrt(factor) keeps the eroded volume close to a single-level run
+    const int coarseDroplets = (int)(numDroplets * (1.0f - detailFraction) / (factor * factor * std::sqrt((float)factor)));
+    const int detailDroplets = (int)(numDroplets * detailFraction);
+
+    std::cout << "Multiresolution erosion: " << coarseDroplets << " droplets at " << coarseWidth << "x" << coarseHeight
+              << ", then " << detailDroplets << " at full resolution" << std::endl;
+
+    // Box-filtered copy; blocks on the far edges average the cells they have
+    World coarse(coarseWidth, coarseHeight, 1, world.getSeed());
+    coarse.setVerbose(false);
+    Grid2D<float> &coarseMap = coarse.getElevationMap();
+    const Grid2D<float> &fineMap = world.getElevationMap();
+    auto downsampleBand = [&](int y0, int y1, int)
+    {
+        for (int cy = y0; cy < y1; cy++)
         {
-            continue;
+            for (int cx = 0; cx < coarseWidth; cx++)
+            {
+                const int fx1 = std::min(mapWidth, (cx + 1) * factor);
+                const int fy1 = std::min(mapHeight, (cy + 1) * factor);
+                float sum = 0.0f;
+                int count = 0;
+                for (int fy = std::min(cy * factor, mapHeight - 1); fy < fy1; fy++)
+                {
+                    for (int fx = std::min(cx * factor, mapWidth - 1); fx < fx1; fx++)
+                    {
+                        sum += fineMap(fx, fy);
+                        count++;
+                    }
+                }
+                coarseMap(cx, cy) = sum / count;
+            }
         }
+    };
+    Parallel::forEachChunk(coarseHeight, Parallel::ROW_BAND, downsampleBand);
+    coarse.assignTerrainTypes();
+
+    // The coarse droplets take the world's next indices, ahead of the detail pass
+    const Grid2D<float> coarseBefore = coarseMap;
+    coarse.setDropletsDrawn(world.getDropletsDrawn());
+    erodeDroplets(coarse, coarseDroplets);
+    world.setDropletsDrawn(coarse.getDropletsDrawn());
+
+    // Bilinear upsampling of the change, sampling coarse cell centres
+    Grid2D<float> &elevation = world.getElevationMap();
+    const float scale = 1.0f / factor;
+    auto upsampleBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const float cyf = std::max(0.0f, std::min((float)(coarseHeight - 1), (y + 0.5f) * scale - 0.5f));
+            const int cy0 = std::min((int)cyf, coarseHeight - 2);
+            const float ty = cyf - cy0;
+            float *row = elevation.row(y);
+            for (int x = 0; x < mapWidth; x++)
+            {
+                const float cxf = std::max(0.0f, std::min((float)(coarseWidth - 1), (x + 0.5f) * scale - 0.5f));
+                const int cx0 = std::min((int)cxf, coarseWidth - 2);
+                const float tx = cxf - cx0;
 
-        Droplet droplet(startX, startY);
-        droplet.water = params.startWater;
-        droplet.velocity = params.startVelocity;
+                const float d00 = coarseMap(cx0, cy0) - coarseBefore(cx0, cy0);
+                const float d10 = coarseMap(cx0 + 1, cy0) - coarseBefore(cx0 + 1, cy0);
+                const float d01 = coarseMap(cx0, cy0 + 1) - coarseBefore(cx0, cy0 + 1);
+                const float d11 = coarseMap(cx0 + 1, cy0 + 1) - coarseBefore(cx0 + 1, cy0 + 1);
+                const float delta = bilinearInterpolate(d00, d10, d01, d11, tx, ty);
 
-        simulateDroplet(world, droplet);
+                row[x] = std::max(-1.0f, std::min(1.0f, row[x] + delta));
+            }
+        }
+    };
+    Parallel::forEachChunk(mapHeight, Parallel::ROW_BAND, upsampleBand);
+    world.assignTerrainTypes();
+
+    erodeDroplets(world, detailDroplets);
+}
 
-        if (i % progressInterval == 0)
+GridRect ErosionSimulator::erodeRegion(World &world, const GridRect &region, int numDroplets)
+{
+    const int mapWidth = world.getWidth();
+    const int mapHeight = world.getHeight();
+    const GridRect area = region.clipped(mapWidth, mapHeight);
+
+    const std::vector<uint32_t> spawnCells = getSpawnCells(world, area);
+    if (spawnCells.empty() || numDroplets <= 0)
+    {
+        std::cout << "No land to erode in region." << std::endl;
+        return GridRect();
+    }
+
+    std::cout << "Eroding region " << area.getWidth() << "x" << area.getHeight() << " at (" << area.x0 << ", " << area.y0
+              << ") with " << numDroplets << " droplets..." << std::endl;
+    prepareBrush(mapWidth);
+
+    // Droplets cannot touch anything beyond their reach, so comparing against a copy of this
+    // window finds every modified cell at a cost proportional to the region
+    const GridRect reach = area.expanded(getDropletReach()).clipped(mapWidth, mapHeight);
+    Grid2D<float> &map = world.getElevationMap();
+    Grid2D<float> before(reach.getWidth(), reach.getHeight());
+    for (int y = reach.y0; y < reach.y1; y++)
+    {
+        std::copy(map.row(y) + reach.x0, map.row(y) + reach.x1, before.row(y - reach.y0));
+    }
+
+    const uint64_t firstIndex = world.reserveDroplets(numDroplets);
+    for (int first = 0; first < numDroplets; first += DROPLET_BATCH)
+    {
+        runLandDroplets(world, spawnCells, (uint32_t)world.getSeed(), firstIndex + first, std::min(DROPLET_BATCH, numDroplets - first));
+    }
+
+    GridRect dirty;
+    for (int y = reach.y0; y < reach.y1; y++)
+    {
+        const float *now = map.row(y);
+        const float *old = before.row(y - reach.y0) - reach.x0;
+        for (int x = reach.x0; x < reach.x1; x++)
         {
-            std::cout << "Erosion progress: " << (i * 100 / numDroplets) << "%" << std::endl;
+            if (now[x] != old[x])
+                dirty.include(x, y);
         }
     }
 
+    world.assignTerrainTypes(dirty);
+    return dirty;
+}
+
+void ErosionSimulator::erodeTiled(World &world, const std::vector<uint32_t> &landCells, int numDroplets)
+{
+    const int mapWidth = world.getWidth();
+    const int mapHeight = world.getHeight();
+
+    // Same-colour tiles are a whole tile apart, so a gap wider than two reaches keeps them independent
+    const int tileSize = 2 * getDropletReach() + 2;
+    const int tilesX = Parallel::chunkCount(mapWidth, tileSize);
+    const int tilesY = Parallel::chunkCount(mapHeight, tileSize);
+    const uint64_t firstIndex = world.reserveDroplets(numDroplets);
+    const uint32_t worldSeed = (uint32_t)world.getSeed();
+
+    std::cout << "Starting tiled erosion simulation with " << numDroplets << " droplets in "
+              << tilesX * tilesY << " tiles on " << Parallel::getThreadCount() << " threads..." << std::endl;
+
+    // Group the land cells by tile (keeping row-major order within each tile)
+    const int tileCount = tilesX * tilesY;
+    auto tileOf = [&](uint32_t cell)
+    {
+        return (int)(cell / mapWidth) / tileSize * tilesX + (int)(cell % mapWidth) / tileSize;
+    };
+    std::vector<uint32_t> firstLandCell(tileCount + 1, 0);
+    for (uint32_t cell : landCells)
+    {
+        firstLandCell[tileOf(cell) + 1]++;
+    }
+    for (int tile = 0; tile < tileCount; tile++)
+    {
+        firstLandCell[tile + 1] += firstLandCell[tile];
+    }
+    std::vector<uint32_t> tileLandCells(landCells.size());
+    std::vector<uint32_t> fillPosition(firstLandCell.begin(), firstLandCell.end() - 1);
+    for (uint32_t cell : landCells)
+    {
+        tileLandCells[fillPosition[tileOf(cell)]++] = cell;
+    }
+
+    // Droplets are shared out in proportion to each tile's land
+    std::vector<int> firstDroplet(tileCount + 1, 0);
+    for (int tile = 0; tile < tileCount; tile++)
+    {
+        firstDroplet[tile + 1] = (int)((double)numDroplets * firstLandCell[tile + 1] / landCells.size());
+    }
+    firstDroplet.back() = numDroplets;
+
+    auto runTile = [&](int tile)
+    {
+        const uint32_t *cells = tileLandCells.data() + firstLandCell[tile];
+        const int cellCount = (int)(firstLandCell[tile + 1] - firstLandCell[tile]);
+
+        float startX[DROPLET_BATCH];
+        float startY[DROPLET_BATCH];
+        for (int first = firstDroplet[tile]; first < firstDroplet[tile + 1]; first += DROPLET_BATCH)
+        {
+            const int count = std::min(DROPLET_BATCH, firstDroplet[tile + 1] - first);
+            for (int i = 0; i < count; i++)
+            {
+                Random::Generator random(worldSeed, Random::Subsystem::EROSION_DROPLETS, firstIndex + first + i);
+                const uint32_t cell = cells[random.nextInt(cellCount)];
+                startX[i] = (float)(cell % mapWidth) + random.nextFloat();
+                startY[i] = (float)(cell / mapWidth) + random.nextFloat();
+            }
+            runDroplets(world, startX, startY, count);
+        }
+    };
+
+    for (int phase = 0; phase < 4; phase++)
+    {
+        std::vector<int> phaseTiles;
+        for (int ty = phase / 2; ty < tilesY; ty += 2)
+        {
+            for (int tx = phase % 2; tx < tilesX; tx += 2)
+            {
+                phaseTiles.push_back(ty * tilesX + tx);
+            }
+        }
+
+        auto runTiles = [&](int begin, int end, int)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                runTile(phaseTiles[i]);
+            }
+        };
+        Parallel::forEachChunk((int)phaseTiles.size(), 1, runTiles);
+
+        std::cout << "Erosion progress: " << (phase + 1) * 25 << "%" << std::endl;
+    }
+
     std::cout << "Erosion simulation complete." << std::endl;
 
     world.assignTerrainTypes();
 }
 
+void ErosionSimulator::erodeThermal(World &world)
+{
+    thermalErosion.run(world.getElevationMap(), true);
+    world.assignTerrainTypes();
+}
+
+void ErosionSimulator::simulateDroplets(World &world, const std::vector<std::pair<float, float>> &startPositions)
+{
+    prepareBrush(world.getWidth());
+
+    float startX[DROPLET_BATCH];
+    float startY[DROPLET_BATCH];
+    const int total = (int)startPositions.size();
+    for (int first = 0; first < total; first += DROPLET_BATCH)
+    {
+        const int count = std::min(DROPLET_BATCH, total - first);
+        for (int i = 0; i < count; i++)
+        {
+            startX[i] = startPositions[first + i].first;
+            startY[i] = startPositions[first + i].second;
+        }
+        runDroplets(world, startX, startY, count);
+    }
+}
+
+void ErosionSimulator::runDroplets(World &world, const float *startX, const float *startY, int count)
+{
+    if (dropletKernel == DropletKernel::BATCHED)
+    {
+        simulateDropletBatch(world.getElevationMap(), startX, startY, count);
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        spawnDroplet(world, startX[i], startY[i]);
+    }
+}
+
+void ErosionSimulator::spawnDroplet(World &world, float startX, float startY)
+{
+    // Droplets starting in the sea do nothing useful
+    if (world.getElevation((int)startX, (int)startY) < -0.1f)
+    {
+        return;
+    }
+
+    Droplet droplet(startX, startY);
+    droplet.water = params.startWater;
+    droplet.velocity = params.startVelocity;
+
+    simulateDroplet(world, droplet);
+}
+
 void ErosionSimulator::simulateDroplet(World &world, Droplet &droplet)
 {
+    Grid2D<float> &map = world.getElevationMap();
+    const int mapWidth = map.getWidth();
+    const int mapHeight = map.getHeight();
+
     for (int lifetime = 0; lifetime < params.maxLifetime; lifetime++)
     {
         int nodeX = (int)droplet.x;
         int nodeY = (int)droplet.y;
 
-        if (nodeX < 0 || nodeX >= world.getWidth() - 1 || nodeY < 0 || nodeY >= world.getHeight() - 1)
+        if (nodeX < 0 || nodeX >= mapWidth - 1 || nodeY < 0 || nodeY >= mapHeight - 1)
         {
             break;
         }
         float height, gradX, gradY;
-        getHeightAndGradient(world, droplet.x, droplet.y, height, gradX, gradY);
+        getHeightAndGradient(map, droplet.x, droplet.y, height, gradX, gradY);
 
         droplet.dx = droplet.dx * params.inertia - gradX * (1 - params.inertia);
         droplet.dy = droplet.dy * params.inertia - gradY * (1 - params.inertia);
@@ -73,13 +518,13 @@ void ErosionSimulator::simulateDroplet(World &world, Droplet &droplet)
         droplet.x += droplet.dx;
         droplet.y += droplet.dy;
 
-        if ((droplet.dx == 0 && droplet.dy == 0) || droplet.x < 0 || droplet.x >= world.getWidth() - 1 || droplet.y < 0 || droplet.y >= world.getHeight() - 1)
+        if ((droplet.dx == 0 && droplet.dy == 0) || droplet.x < 0 || droplet.x >= mapWidth - 1 || droplet.y < 0 || droplet.y >= mapHeight - 1)
         {
             break;
         }
 
         float newHeight, newGradX, newGradY;
-        getHeightAndGradient(world, droplet.x, droplet.y, newHeight, newGradX, newGradY);
+        getHeightAndGradient(map, droplet.x, droplet.y, newHeight, newGradX, newGradY);
 
         float deltaHeight = newHeight - height;
 
@@ -92,36 +537,12 @@ void ErosionSimulator::simulateDroplet(World &world, Droplet &droplet)
 
             droplet.sediment -= amountToDeposit;
 
-            float cellOffsetX = oldX - nodeX;
-            float cellOffsetY = oldY - nodeY;
-
-            world.modifyElevation(nodeX, nodeY, amountToDeposit * (1 - cellOffsetX) * (1 - cellOffsetY));
-            world.modifyElevation(nodeX + 1, nodeY, amountToDeposit * cellOffsetX * (1 - cellOffsetY));
-            world.modifyElevation(nodeX, nodeY + 1, amountToDeposit * (1 - cellOffsetX) * cellOffsetY);
-            world.modifyElevation(nodeX + 1, nodeY + 1, amountToDeposit * cellOffsetX * cellOffsetY);
+            depositSediment(map, nodeX, nodeY, oldX - nodeX, oldY - nodeY, amountToDeposit);
         }
         else
         {
             float amountToErode = std::min((capacity - droplet.sediment) * params.erosion, -deltaHeight);
-
-            for (int brushY = -1; brushY <= 1; brushY++)
-            {
-                for (int brushX = -1; brushX <= 1; brushX++)
-                {
-                    int erodeX = nodeX + brushX;
-                    int erodeY = nodeY + brushY;
-
-                    if (erodeX >= 0 && erodeX < world.getWidth() && erodeY >= 0 && erodeY < world.getHeight())
-                    {
-                        float distance = std::sqrt(brushX * brushX + brushY * brushY);
-                        float weight = std::max(0.0f, 1.0f - distance);
-                        float weightedErosion = amountToErode * weight * 0.25f;
-
-                        world.modifyElevation(erodeX, erodeY, -weightedErosion);
-                        droplet.sediment += weightedErosion;
-                    }
-                }
-            }
+            erodeBrush(map, nodeX, nodeY, amountToErode, droplet.sediment);
         }
 
         droplet.velocity = std::sqrt(std::max(0.0f, droplet.velocity * droplet.velocity + deltaHeight * params.gravity));
@@ -135,18 +556,221 @@ void ErosionSimulator::simulateDroplet(World &world, Droplet &droplet)
     }
 }
 
-void ErosionSimulator::getHeightAndGradient(World &world, float x, float y, float &height, float &gradX, float &gradY)
+void ErosionSimulator::depositSediment(Grid2D<float> &map, int nodeX, int nodeY, float cellOffsetX, float cellOffsetY, float amount)
+{
+    // The node and its +1 neighbours are inside the map (callers check before stepping)
+    float *row0 = map.row(nodeY) + nodeX;
+    float *row1 = map.row(nodeY + 1) + nodeX;
+    addClamped(row0[0], amount * (1 - cellOffsetX) * (1 - cellOffsetY));
+    addClamped(row0[1], amount * cellOffsetX * (1 - cellOffsetY));
+    addClamped(row1[0], amount * (1 - cellOffsetX) * cellOffsetY);
+    addClamped(row1[1], amount * cellOffsetX * cellOffsetY);
+}
+
+void ErosionSimulator::erodeBrush(Grid2D<float> &map, int nodeX, int nodeY, float amount, float &sediment)
 {
+    const int mapWidth = map.getWidth();
+    const int mapHeight = map.getHeight();
+    const int brushCells = (int)brushIndices.size();
+
+    if (nodeX >= brushRadius && nodeX < mapWidth - brushRadius && nodeY >= brushRadius && nodeY < mapHeight - brushRadius)
+    {
+        float *node = map.row(nodeY) + nodeX;
+        for (int i = 0; i < brushCells; i++)
+        {
+            float weightedErosion = amount * brushWeights[i];
+            addClamped(node[brushIndices[i]], -weightedErosion);
+            sediment += weightedErosion;
+        }
+        return;
+    }
+
+    // Near the border the part of the brush inside the map takes the whole amount
+    float insideWeight = 0.0f;
+    for (int i = 0; i < brushCells; i++)
+    {
+        if (map.inBounds(nodeX + brushOffsetX[i], nodeY + brushOffsetY[i]))
+            insideWeight += brushWeights[i];
+    }
+
+    for (int i = 0; i < brushCells; i++)
+    {
+        int erodeX = nodeX + brushOffsetX[i];
+        int erodeY = nodeY + brushOffsetY[i];
+        if (map.inBounds(erodeX, erodeY))
+        {
+            float weightedErosion = amount * brushWeights[i] / insideWeight;
+            addClamped(map(erodeX, erodeY), -weightedErosion);
+            sediment += weightedErosion;
+        }
+    }
+}
+
+void ErosionSimulator::simulateDropletBatch(Grid2D<float> &map, const float *startX, const float *startY, int count)
+{
+    const int mapWidth = map.getWidth();
+    const int mapHeight = map.getHeight();
+
+    alignas(32) float x[LANES], y[LANES], dirX[LANES], dirY[LANES], oldX[LANES], oldY[LANES];
+    alignas(32) float velocity[LANES], water[LANES], sediment[LANES];
+    alignas(32) float height[LANES], gradX[LANES], gradY[LANES];
+    alignas(32) float newHeight[LANES], newGradX[LANES], newGradY[LANES];
+    alignas(32) int32_t alive[LANES]; // all bits set while the droplet is running
+
+    // Same start conditions as spawnDroplet and the first bounds check of simulateDroplet
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        x[lane] = lane < count ? startX[lane] : 0.0f;
+        y[lane] = lane < count ? startY[lane] : 0.0f;
+        int nodeX = (int)x[lane];
+        int nodeY = (int)y[lane];
+        bool valid = lane < count && nodeX >= 0 && nodeX < mapWidth - 1 && nodeY >= 0 && nodeY < mapHeight - 1 &&
+                     map(nodeX, nodeY) >= -0.1f;
+
+        alive[lane] = valid ? -1 : 0;
+        dirX[lane] = 0.0f;
+        dirY[lane] = 0.0f;
+        velocity[lane] = params.startVelocity;
+        water[lane] = params.startWater;
+        sediment[lane] = 0.0f;
+    }
+
+    sampleBatch(map, x, y, alive, height, gradX, gradY);
+
+    for (int lifetime = 0; lifetime < params.maxLifetime; lifetime++)
+    {
+        int running = 0;
+        for (int lane = 0; lane < LANES; lane++)
+        {
+            running += alive[lane] != 0;
+        }
+        if (running == 0)
+        {
+            break;
+        }
+
+        // Steer and move every lane together
+        for (int lane = 0; lane < LANES; lane++)
+        {
+            float dx = dirX[lane] * params.inertia - gradX[lane] * (1 - params.inertia);
+            float dy = dirY[lane] * params.inertia - gradY[lane] * (1 - params.inertia);
+            float len = std::sqrt(dx * dx + dy * dy);
+            if (len != 0)
+            {
+                dx /= len;
+                dy /= len;
+            }
+            dirX[lane] = dx;
+            dirY[lane] = dy;
+
+            oldX[lane] = x[lane];
+            oldY[lane] = y[lane];
+            x[lane] += dx;
+            y[lane] += dy;
+
+            bool stopped = (dx == 0 && dy == 0) || x[lane] < 0 || x[lane] >= mapWidth - 1 || y[lane] < 0 || y[lane] >= mapHeight - 1;
+            alive[lane] = stopped ? 0 : alive[lane];
+        }
+
+        sampleBatch(map, x, y, alive, newHeight, newGradX, newGradY);
+
+        // Map updates go lane by lane so droplets touching the same cells stay well defined
+        for (int lane = 0; lane < LANES; lane++)
+        {
+            if (!alive[lane])
+                continue;
+
+            int nodeX = (int)oldX[lane];
+            int nodeY = (int)oldY[lane];
+            float deltaHeight = newHeight[lane] - height[lane];
+
+            float slope = std::max(-deltaHeight, params.minSlope);
+            float capacity = slope * velocity[lane] * water[lane] * params.capacity;
+
+            if (sediment[lane] > capacity || deltaHeight > 0)
+            {
+                float amountToDeposit = (deltaHeight > 0) ? std::min(deltaHeight, sediment[lane]) : (sediment[lane] - capacity) * params.deposition;
+                sediment[lane] -= amountToDeposit;
+                depositSediment(map, nodeX, nodeY, oldX[lane] - nodeX, oldY[lane] - nodeY, amountToDeposit);
+            }
+            else
+            {
+                float amountToErode = std::min((capacity - sediment[lane]) * params.erosion, -deltaHeight);
+                erodeBrush(map, nodeX, nodeY, amountToErode, sediment[lane]);
+            }
+
+            velocity[lane] = std::sqrt(std::max(0.0f, velocity[lane] * velocity[lane] + deltaHeight * params.gravity));
+            water[lane] *= (1 - params.evaporation);
+            if (water[lane] < 0.001f)
+            {
+                alive[lane] = 0;
+            }
+
+            // Carry the sample forward: next step starts from here
+            height[lane] = newHeight[lane];
+            gradX[lane] = newGradX[lane];
+            gradY[lane] = newGradY[lane];
+        }
+    }
+}
+
+void ErosionSimulator::prepareBrush(int mapWidth)
+{
+    const int radius = std::max(1, params.erosionRadius);
+    if (mapWidth == brushMapWidth && radius == brushRadius)
+    {
+        return;
+    }
+
+    brushMapWidth = mapWidth;
+    brushRadius = radius;
+    brushIndices.clear();
+    brushOffsetX.clear();
+    brushOffsetY.clear();
+    brushWeights.clear();
+
+    // Weights fall off linearly to zero one cell beyond the radius, so every offset up to radius
+    // along each axis gets some weight and radius 1 covers the 3x3 neighbourhood
+    float weightSum = 0.0f;
+    for (int offsetY = -radius; offsetY <= radius; offsetY++)
+    {
+        for (int offsetX = -radius; offsetX <= radius; offsetX++)
+        {
+            float distance = std::sqrt((float)(offsetX * offsetX + offsetY * offsetY));
+            if (distance < radius + 1)
+            {
+                float weight = 1.0f - distance / (radius + 1);
+                brushIndices.push_back(offsetY * mapWidth + offsetX);
+                brushOffsetX.push_back(offsetX);
+                brushOffsetY.push_back(offsetY);
+                brushWeights.push_back(weight);
+                weightSum += weight;
+            }
+        }
+    }
+
+    for (float &weight : brushWeights)
+    {
+        weight /= weightSum;
+    }
+}
+
+void ErosionSimulator::getHeightAndGradient(const Grid2D<float> &map, float x, float y, float &height, float &gradX, float &gradY)
+{
+    // Callers guarantee 0 <= x < width - 1 and 0 <= y < height - 1
     int coordX = (int)x;
     int coordY = (int)y;
 
     float u = x - coordX;
     float v = y - coordY;
 
-    float heightNW = world.getElevation(coordX, coordY);
-    float heightNE = world.getElevation(coordX + 1, coordY);
-    float heightSW = world.getElevation(coordX, coordY + 1);
-    float heightSE = world.getElevation(coordX + 1, coordY + 1);
+    const float *row0 = map.row(coordY) + coordX;
+    const float *row1 = map.row(coordY + 1) + coordX;
+
+    float heightNW = row0[0];
+    float heightNE = row0[1];
+    float heightSW = row1[0];
+    float heightSE = row1[1];
 
     gradX = (heightNE - heightNW) * (1 - v) + (heightSE - heightSW) * v;
     gradY = (heightSW - heightNW) * (1 - u) + (heightSE - heightNE) * u;
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <vector>
-#include <random>
+#include <algorithm>
+#include <cstdint>
+#include "Grid2D.h"
+#include "PipeErosion.h"
+#include "ThermalErosion.h"
 
 class World;
 
@@ -18,6 +22,41 @@ struct Droplet
 
 class ErosionSimulator
 {
+    friend class ErosionJob;
+
+public:
+    // SEQUENTIAL runs every droplet in order (the reference).
+    // TILED splits the map into tiles wider than twice a droplet's reach and runs them as a
+    // 2x2 checkerboard: tiles of one colour cannot touch each other's cells, so each phase
+    // runs its tiles in parallel. Droplet start points are keyed by the world's seed and
+    // droplet index, so the result never depends on the thread count.
+    enum class Schedule
+    {
+        SEQUENTIAL,
+        TILED
+    };
+
+    // SCALAR simulates one droplet at a time (the reference). BATCHED advances DROPLET_BATCH
+    // droplets in lockstep in struct-of-arrays form, sampling the map with vector gathers where
+    // the build enables AVX2. It reuses each step's sample at the new position as the next step's
+    // starting sample instead of re-reading it after the map update, so results differ slightly.
+    enum class DropletKernel
+    {
+        SCALAR,
+        BATCHED
+    };
+
+    static constexpr int DROPLET_BATCH = 8;
+
+    // DROPLETS simulates individual raindrops (cost grows with the droplet count, scattered
+    // writes). PIPE runs the grid-based shallow-water model in PipeErosion (fixed cost per
+    // iteration, every pass a parallel stencil).
+    enum class Engine
+    {
+        DROPLETS,
+        PIPE
+    };
+
 private:
     struct Parameters
     {
@@ -30,26 +69,101 @@ private:
         float gravity = 4.0f;
         float minSlope = 0.01f;
         int maxLifetime = 30;
+        int erosionRadius = 3; // cells up to this far from the droplet's node are eroded (1 = 3x3)
         float startWater = 1.0f;
         float startVelocity = 1.0f;
     } params;
 
-    std::mt19937 rng;
-    std::uniform_real_distribution<float> uniformDist;
+    Engine engine = Engine::DROPLETS;
+    PipeErosion pipeErosion;
+    ThermalErosion thermalErosion;
+    Schedule schedule = Schedule::SEQUENTIAL;
+    DropletKernel dropletKernel = DropletKernel::SCALAR;
+    int multiresolutionFactor = 1; // 1 = single level
+    float detailFraction = 0.25f;
+
+    // Erosion brush, rebuilt when the map width or radius changes: flat index offsets from the
+    // droplet's node, the matching x/y offsets for border cells, and weights summing to 1
+    int brushMapWidth = -1;
+    int brushRadius = -1;
+    std::vector<int> brushIndices;
+    std::vector<int> brushOffsetX;
+    std::vector<int> brushOffsetY;
+    std::vector<float> brushWeights;
+
+    void erodeDroplets(World &world, int numDroplets);
+    void erodeMultiresolution(World &world, int numDroplets);
+    void erodeTiled(World &world, const std::vector<uint32_t> &landCells, int numDroplets);
+    void prepareBrush(int mapWidth);
 
+    // Land cells of area that droplets can start on, in row-major order. The last row and column
+    // are left out: a droplet starting there is off the interpolation grid and dies at once.
+    static std::vector<uint32_t> getSpawnCells(const World &world, const GridRect &area);
+
+    // Runs count (at most DROPLET_BATCH) droplets of streamSeed's stream from firstDroplet on,
+    // each starting at a random point of a random cell from landCells. Returns the cells they
+    // can have changed: their start cells grown by the droplet reach.
+    GridRect runLandDroplets(World &world, const std::vector<uint32_t> &landCells, unsigned int streamSeed,
+                         uint64_t firstDroplet, int count);
+    void runDroplets(World &world, const float *startX, const float *startY, int count);
+    void spawnDroplet(World &world, float startX, float startY);
     void simulateDroplet(World &world, Droplet &droplet);
-    void getHeightAndGradient(World &world, float x, float y, float &height, float &gradX, float &gradY);
+    void simulateDropletBatch(Grid2D<float> &map, const float *startX, const float *startY, int count);
+    void depositSediment(Grid2D<float> &map, int nodeX, int nodeY, float cellOffsetX, float cellOffsetY, float amount);
+    void erodeBrush(Grid2D<float> &map, int nodeX, int nodeY, float amount, float &sediment);
+    void getHeightAndGradient(const Grid2D<float> &map, float x, float y, float &height, float &gradX, float &gradY);
     float bilinearInterpolate(float v00, float v10, float v01, float v11, float fx, float fy);
 
 public:
-    ErosionSimulator(unsigned int seed = 0);
+    ErosionSimulator();
 
+    // numDroplets only applies to the droplet engine; the pipe engine runs its configured iterations
     void erode(World &world, int numDroplets = -1);
 
+    // Droplet erosion confined to one area: droplets start only on land inside region, and only
+    // the cells they changed are reclassified. Returns the bounding box of those cells, for
+    // updating anything derived from elevation (e.g. ClimateSystem::updateRegion).
+    GridRect erodeRegion(World &world, const GridRect &region, int numDroplets);
+
+    // Lets material slide down slopes steeper than the talus angle; a few sweeps relax the
+    // cliffs that would otherwise take a large droplet budget to wear down
+    void erodeThermal(World &world);
+
+    // Runs one droplet from each given start position (map coordinates), in order
+    void simulateDroplets(World &world, const std::vector<std::pair<float, float>> &startPositions);
+
+    void setEngine(Engine newEngine) { engine = newEngine; }
+    Engine getEngine() const { return engine; }
+    PipeErosion &getPipeErosion() { return pipeErosion; }
+    ThermalErosion &getThermalErosion() { return thermalErosion; }
+
+    void setSchedule(Schedule newSchedule) { schedule = newSchedule; }
+    Schedule getSchedule() const { return schedule; }
+    // Coarse-to-fine droplet erosion: (1 - detailFraction) of the budget is spent on a map shrunk
+    // by factor in each direction (each droplet there standing in for factor^2 full-size ones),
+    // the rest at full resolution. factor 1 turns it off.
+    void setMultiresolution(int factor, float detail = 0.25f)
+    {
+        multiresolutionFactor = std::max(1, factor);
+        detailFraction = std::max(0.0f, std::min(1.0f, detail));
+    }
+    int getMultiresolutionFactor() const { return multiresolutionFactor; }
+
+    void setDropletKernel(DropletKernel kernel) { dropletKernel = kernel; }
+    DropletKernel getDropletKernel() const { return dropletKernel; }
+
+    // Instruction set the batched droplet kernel samples the map with
+    static const char *batchKernelName();
+
+    // Furthest a droplet can read or modify the map from its start cell: one cell per step, the
+    // brush radius around its node, and the cell beyond its position that interpolation touches
+    int getDropletReach() const { return params.maxLifetime + std::max(1, params.erosionRadius) + 1; }
+
     void setErosionStrength(float strength) { params.erosion = strength; }
     void setDepositionRate(float rate) { params.deposition = rate; }
     void setEvaporationRate(float rate) { params.evaporation = rate; }
     void setCapacityMultiplier(float mult) { params.capacity = mult; }
 
     Parameters &getParameters() { return params; }
+    const Parameters &getParameters() const { return params; }
 };
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "ErosionJob.h"
+#include "Erosion.h"
+#include "World.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    const char FILE_MAGIC[4] = {'G', 'E', 'R', 'O'};
+    const uint32_t FILE_VERSION = 1;
+}
+
+ErosionJob::ErosionJob(ErosionSimulator &simulator, World &world, int numDroplets)
+    : simulator(simulator), world(world)
+{
+    state.seed = (unsigned int)world.getSeed();
+    state.landCells = ErosionSimulator::getSpawnCells(world, GridRect(0, 0, world.getWidth(), world.getHeight()));
+    if (state.landCells.empty())
+    {
+        std::cout << "No land to erode." << std::endl;
+        return;
+    }
+
+    state.totalDroplets = std::max(0, numDroplets);
+    state.firstDroplet = world.reserveDroplets(state.totalDroplets);
+}
+
+ErosionJob::ErosionJob(ErosionSimulator &simulator, World &world, const Checkpoint &checkpoint)
+    : simulator(simulator), world(world), state(checkpoint)
+{
+    if (state.seed == (unsigned int)world.getSeed())
+    {
+        world.setDropletsDrawn(std::max(world.getDropletsDrawn(), state.firstDroplet + state.totalDroplets));
+    }
+}
+
+bool ErosionJob::step(double budgetMs)
+{
+    if (isFinished())
+    {
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    simulator.prepareBrush(world.getWidth());
+    GridRect dirty;
+
+    // Whole batches only, aligned to the first droplet, so the batched kernel groups the
+    // droplets exactly as a single erode() call would
+    do
+    {
+        const int count = std::min(ErosionSimulator::DROPLET_BATCH, state.totalDroplets - state.completedDroplets);
+        dirty.include(simulator.runLandDroplets(world, state.landCells, state.seed,
+                                                state.firstDroplet + state.completedDroplets, count));
+        state.completedDroplets += count;
+    } while (state.completedDroplets < state.totalDroplets &&
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < budgetMs);
+
+    if (!dirty.isEmpty())
+    {
+        world.assignTerrainTypes(dirty);
+    }
+    return !isFinished();
+}
+
+bool ErosionJob::save(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    const Grid2D<float> &elevation = world.getElevationMap();
+    int32_t width = elevation.getWidth();
+    int32_t height = elevation.getHeight();
+    uint32_t cellCount = (uint32_t)state.landCells.size();
+    file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&FILE_VERSION), sizeof(FILE_VERSION));
+    file.write(reinterpret_cast<const char *>(&width), sizeof(width));
+    file.write(reinterpret_cast<const char *>(&height), sizeof(height));
+    file.write(reinterpret_cast<const char *>(&state.seed), sizeof(state.seed));
+    file.write(reinterpret_cast<const char *>(&state.firstDroplet), sizeof(state.firstDroplet));
+    file.write(reinterpret_cast<const char *>(&state.totalDroplets), sizeof(state.totalDroplets));
+    file.write(reinterpret_cast<const char *>(&state.completedDroplets), sizeof(state.completedDroplets));
+    file.write(reinterpret_cast<const char *>(&cellCount), sizeof(cellCount));
+    file.write(reinterpret_cast<const char *>(state.landCells.data()), cellCount * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char *>(elevation.data()), elevation.size() * sizeof(float));
+
+    if (!file)
+    {
+        std::cerr << "Could not write erosion checkpoint " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ErosionJob::load(const std::string &path, World &world, Checkpoint &checkpoint)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    int32_t width = 0, height = 0;
+    uint32_t cellCount = 0;
+    Checkpoint loaded;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&width), sizeof(width));
+    file.read(reinterpret_cast<char *>(&height), sizeof(height));
+    file.read(reinterpret_cast<char *>(&loaded.seed), sizeof(loaded.seed));
+    file.read(reinterpret_cast<char *>(&loaded.firstDroplet), sizeof(loaded.firstDroplet));
+    file.read(reinterpret_cast<char *>(&loaded.totalDroplets), sizeof(loaded.totalDroplets));
+    file.read(reinterpret_cast<char *>(&loaded.completedDroplets), sizeof(loaded.completedDroplets));
+    file.read(reinterpret_cast<char *>(&cellCount), sizeof(cellCount));
+
+    if (!file || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 || version != FILE_VERSION ||
+        width != world.getWidth() || height != world.getHeight() || cellCount > (uint32_t)width * (uint32_t)height)
+        return false;
+
+    loaded.landCells.resize(cellCount);
+    file.read(reinterpret_cast<char *>(loaded.landCells.data()), cellCount * sizeof(uint32_t));
+    Grid2D<float> elevation(width, height);
+    file.read(reinterpret_cast<char *>(elevation.data()), elevation.size() * sizeof(float));
+    if (!file)
+        return false;
+
+    world.getElevationMap() = std::move(elevation);
+    world.assignTerrainTypes();
+    checkpoint = std::move(loaded);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class World;
+class ErosionSimulator;
+
+// Droplet erosion that runs in slices: step() simulates droplets until its time budget is spent,
+// so a viewer can erode a little every frame and a batch run can stop a long job early.
+// Droplets run in the SEQUENTIAL order with the simulator's droplet kernel, and the job keeps its
+// own droplet cursor and spawn cells, so a finished job leaves the same map as erode() would
+// however its steps were sliced.
+class ErosionJob
+{
+public:
+    // Everything needed to carry on later; the world's elevation must be kept alongside.
+    // save() and load() write both to a file so a job can resume in another process.
+    struct Checkpoint
+    {
+        unsigned int seed = 0;     // the world's seed
+        uint64_t firstDroplet = 0; // random stream index of droplet 0
+        int totalDroplets = 0;
+        int completedDroplets = 0;
+        std::vector<uint32_t> landCells; // spawn cells, fixed when the job was created
+    };
+
+private:
+    ErosionSimulator &simulator;
+    World &world;
+    Checkpoint state;
+    bool cancelled = false;
+
+public:
+    // Reserves the next numDroplets droplets of the world's stream, so later erode() calls
+    // still draw fresh ones
+    ErosionJob(ErosionSimulator &simulator, World &world, int numDroplets);
+
+    // Resumes a checkpointed job on a world holding the elevation saved with it
+    ErosionJob(ErosionSimulator &simulator, World &world, const Checkpoint &checkpoint);
+
+    // Simulates droplets for about budgetMs milliseconds (at least one batch), then reclassifies
+    // the terrain they can have changed so the world can be shown as it is. Returns true while
+    // droplets remain.
+    bool step(double budgetMs);
+
+    void cancel() { cancelled = true; }
+    bool isCancelled() const { return cancelled; }
+    bool isFinished() const { return cancelled || state.completedDroplets >= state.totalDroplets; }
+
+    float getProgress() const { return state.totalDroplets > 0 ? (float)state.completedDroplets / state.totalDroplets : 1.0f; }
+    int getCompletedDroplets() const { return state.completedDroplets; }
+    int getTotalDroplets() const { return state.totalDroplets; }
+
+    const Checkpoint &checkpoint() const { return state; }
+
+    // Writes the checkpoint and the world's elevation to path
+    bool save(const std::string &path) const;
+
+    // Reads a file written by save() into checkpoint and the elevation of world, which must have
+    // the saved size, and reclassifies its terrain. Returns false, leaving both untouched, if the
+    // file is missing or does not match.
+    static bool load(const std::string &path, World &world, Checkpoint &checkpoint);
+};
\ No newline at end of file
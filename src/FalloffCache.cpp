@@ -0,0 +1,154 @@
+#include "FalloffCache.h"
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    struct Entry
+    {
+        std::shared_ptr<const FalloffCache::Field> field;
+        uint64_t lastUse;
+    };
+
+    std::mutex cacheMutex;
+    std::map<FalloffCache::Key, Entry> entries;
+    std::string diskDirectory;
+    int capacity = 4;
+    uint64_t useCounter = 0;
+
+    const char FILE_MAGIC[4] = {'G', 'F', 'A', 'L'};
+    const uint32_t FILE_VERSION = 1;
+
+    uint32_t floatBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    std::string filePath(const FalloffCache::Key &key)
+    {
+        // Falloff parameters are encoded by their exact bit patterns so nearby values never collide
+        std::ostringstream name;
+        name << diskDirectory << "/falloff_" << key.width << "x" << key.height << "_m" << key.mode
+             << "_" << std::hex << floatBits(key.falloffA) << "_" << floatBits(key.falloffB) << ".bin";
+        return name.str();
+    }
+
+    bool loadField(const std::string &path, const FalloffCache::Key &key, FalloffCache::Field &field)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        char magic[4];
+        uint32_t version = 0;
+        int32_t width = 0, height = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        file.read(reinterpret_cast<char *>(&width), sizeof(width));
+        file.read(reinterpret_cast<char *>(&height), sizeof(height));
+
+        if (!file || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 || version != FILE_VERSION ||
+            width != key.width || height != key.height)
+            return false;
+
+        field.resize(width, height);
+        file.read(reinterpret_cast<char *>(field.data()), field.size() * sizeof(float));
+        return (bool)file;
+    }
+
+    void saveField(const std::string &path, const FalloffCache::Field &field)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        int32_t width = field.getWidth();
+        int32_t height = field.getHeight();
+        file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+        file.write(reinterpret_cast<const char *>(&FILE_VERSION), sizeof(FILE_VERSION));
+        file.write(reinterpret_cast<const char *>(&width), sizeof(width));
+        file.write(reinterpret_cast<const char *>(&height), sizeof(height));
+        file.write(reinterpret_cast<const char *>(field.data()), field.size() * sizeof(float));
+
+        if (!file)
+        {
+            std::cerr << "Could not write falloff cache file " << path << std::endl;
+        }
+    }
+}
+
+bool FalloffCache::Key::operator<(const Key &other) const
+{
+    if (width != other.width)
+        return width < other.width;
+    if (height != other.height)
+        return height < other.height;
+    if (mode != other.mode)
+        return mode < other.mode;
+    if (floatBits(falloffA) != floatBits(other.falloffA))
+        return floatBits(falloffA) < floatBits(other.falloffA);
+    return floatBits(falloffB) < floatBits(other.falloffB);
+}
+
+std::shared_ptr<const FalloffCache::Field> FalloffCache::get(const Key &key, const std::function<void(Field &)> &compute)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto it = entries.find(key);
+    if (it != entries.end())
+    {
+        it->second.lastUse = ++useCounter;
+        return it->second.field;
+    }
+
+    auto field = std::make_shared<Field>();
+    bool loaded = !diskDirectory.empty() && loadField(filePath(key), key, *field);
+    if (!loaded)
+    {
+        field->resize(key.width, key.height);
+        compute(*field);
+
+        if (!diskDirectory.empty())
+        {
+            saveField(filePath(key), *field);
+        }
+    }
+
+    // Drop the least recently used field when full
+    if ((int)entries.size() >= capacity && !entries.empty())
+    {
+        auto oldest = entries.begin();
+        for (auto e = entries.begin(); e != entries.end(); ++e)
+        {
+            if (e->second.lastUse < oldest->second.lastUse)
+                oldest = e;
+        }
+        entries.erase(oldest);
+    }
+
+    entries[key] = {field, ++useCounter};
+    return field;
+}
+
+void FalloffCache::setDiskCacheDirectory(const std::string &directory)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    diskDirectory = directory;
+}
+
+void FalloffCache::setCapacity(int fields)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    capacity = std::max(1, fields);
+}
+
+void FalloffCache::clear()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    entries.clear();
+}
\ No newline at end of file
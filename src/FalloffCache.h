@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <functional>
+#include "Grid2D.h"
+
+// The island falloff field depends only on map size, island mode and falloff shape, never on
+// the seed. Fields are computed once and shared by every world with the same key, and can
+// optionally be persisted to disk so separate runs skip the falloff math too.
+class FalloffCache
+{
+public:
+    struct Key
+    {
+        int width;
+        int height;
+        int mode;
+        float falloffA;
+        float falloffB;
+
+        bool operator<(const Key &other) const;
+    };
+
+    using Field = Grid2D<float>;
+
+    // Returns the cached field for key, running compute to fill it on a miss
+    static std::shared_ptr<const Field> get(const Key &key, const std::function<void(Field &)> &compute);
+
+    // Directory for on-disk fields; empty (the default) keeps the cache in memory only
+    static void setDiskCacheDirectory(const std::string &directory);
+
+    // Maximum number of fields held in memory (least recently used are dropped first)
+    static void setCapacity(int fields);
+
+    static void clear();
+};
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <algorithm>
+
+// Allocator returning cache-line aligned storage so grid rows can be handed straight to vector kernels
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(std::size_t n)
+    {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *p, std::size_t)
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+// Half-open cell rectangle [x0, x1) x [y0, y1), e.g. the part of a map an edit touched
+struct GridRect
+{
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+
+    GridRect() = default;
+    GridRect(int x0, int y0, int x1, int y1) : x0(x0), y0(y0), x1(x1), y1(y1) {}
+
+    bool isEmpty() const { return x0 >= x1 || y0 >= y1; }
+    int getWidth() const { return x1 - x0; }
+    int getHeight() const { return y1 - y0; }
+
+    // Grows the rectangle to cover cell (x, y); an empty rectangle becomes that cell
+    void include(int x, int y)
+    {
+        if (isEmpty())
+        {
+            *this = GridRect(x, y, x + 1, y + 1);
+            return;
+        }
+        x0 = std::min(x0, x);
+        y0 = std::min(y0, y);
+        x1 = std::max(x1, x + 1);
+        y1 = std::max(y1, y + 1);
+    }
+
+    // Grows the rectangle to cover other as well
+    void include(const GridRect &other)
+    {
+        if (other.isEmpty())
+            return;
+        include(other.x0, other.y0);
+        include(other.x1 - 1, other.y1 - 1);
+    }
+
+    GridRect expanded(int margin) const { return GridRect(x0 - margin, y0 - margin, x1 + margin, y1 + margin); }
+    GridRect clipped(int width, int height) const
+    {
+        return GridRect(std::max(0, x0), std::max(0, y0), std::min(width, x1), std::min(height, y1));
+    }
+};
+
+// Flat, row-major 2D grid used for every map layer.
+// Accessors are unchecked; callers that may step outside the map use inBounds() first.
+template <typename T>
+class Grid2D
+{
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<T, AlignedAllocator<T>> cells;
+
+public:
+    Grid2D() = default;
+    Grid2D(int width, int height, const T &value = T())
+        : width(width), height(height), cells((std::size_t)width * height, value) {}
+
+    void resize(int newWidth, int newHeight, const T &value = T())
+    {
+        width = newWidth;
+        height = newHeight;
+        cells.assign((std::size_t)width * height, value);
+    }
+
+    void fill(const T &value) { std::fill(cells.begin(), cells.end(), value); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    std::size_t size() const { return cells.size(); }
+
+    bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    std::size_t index(int x, int y) const { return (std::size_t)y * width + x; }
+
+    T &operator()(int x, int y) { return cells[(std::size_t)y * width + x]; }
+    const T &operator()(int x, int y) const { return cells[(std::size_t)y * width + x]; }
+
+    T &operator[](std::size_t i) { return cells[i]; }
+    const T &operator[](std::size_t i) const { return cells[i]; }
+
+    // Raw row/span access for hot loops
+    T *row(int y) { return cells.data() + (std::size_t)y * width; }
+    const T *row(int y) const { return cells.data() + (std::size_t)y * width; }
+    T *data() { return cells.data(); }
+    const T *data() const { return cells.data(); }
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "Hydrology.h"
+#include <queue>
+#include <functional>
+#include <utility>
+
+namespace
+{
+    const int NEIGHBOUR_DX[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    const int NEIGHBOUR_DY[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    const float NEIGHBOUR_DISTANCE[8] = {1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.0f, 1.41421356f, 1.0f, 1.41421356f};
+}
+
+void Hydrology::run(const Grid2D<float> &elevation)
+{
+    width = elevation.getWidth();
+    height = elevation.getHeight();
+
+    fillDepressions(elevation);
+    routeFlow();
+    accumulateFlow();
+    classify(elevation);
+}
+
+void Hydrology::clear(int mapWidth, int mapHeight)
+{
+    width = mapWidth;
+    height = mapHeight;
+    filled.resize(0, 0);
+    downstream.resize(width, height, -1);
+    accumulation.resize(width, height, 0);
+    water.resize(width, height, Water::LAND);
+    order.clear();
+}
+
+// Floods inwards from land touching the sea or the map edge, always continuing from the lowest
+// open cell. A neighbour no higher than the current level lies in a depression: it is raised to
+// that level and goes to a plain FIFO, which is drained before the heap, so most of a pit costs
+// O(1) per cell. Ties in the heap break on cell index, so the order is fully determined.
+void Hydrology::fillDepressions(const Grid2D<float> &elevation)
+{
+    filled = elevation;
+    downstream.resize(width, height, -1);
+    order.clear();
+
+    std::vector<uint8_t> visited(filled.size(), 0);
+    typedef std::pair<float, uint32_t> OpenCell;
+    std::priority_queue<OpenCell, std::vector<OpenCell>, std::greater<OpenCell>> open;
+    std::queue<uint32_t> pit;
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const uint32_t cell = (uint32_t)filled.index(x, y);
+            if (filled[cell] < params.seaLevel)
+            {
+                visited[cell] = 1;
+                continue;
+            }
+
+            // Land on the map edge drains off it; land on the coast into its lowest sea neighbour
+            bool outlet = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+            float lowestSea = params.seaLevel;
+            for (int k = 0; k < 8; k++)
+            {
+                const int nx = x + NEIGHBOUR_DX[k];
+                const int ny = y + NEIGHBOUR_DY[k];
+                if (filled.inBounds(nx, ny) && filled(nx, ny) < lowestSea)
+                {
+                    lowestSea = filled(nx, ny);
+                    downstream[cell] = (int32_t)filled.index(nx, ny);
+                    outlet = true;
+                }
+            }
+            if (outlet)
+            {
+                visited[cell] = 1;
+                open.push(OpenCell(filled[cell], cell));
+            }
+        }
+    }
+
+    while (!open.empty() || !pit.empty())
+    {
+        uint32_t cell;
+        if (!pit.empty())
+        {
+            cell = pit.front();
+            pit.pop();
+        }
+        else
+        {
+            cell = open.top().second;
+            open.pop();
+        }
+        order.push_back(cell);
+
+        const int x = (int)(cell % width);
+        const int y = (int)(cell / width);
+        const float level = filled[cell];
+        for (int k = 0; k < 8; k++)
+        {
+            const int nx = x + NEIGHBOUR_DX[k];
+            const int ny = y + NEIGHBOUR_DY[k];
+            if (!filled.inBounds(nx, ny))
+                continue;
+            const uint32_t neighbour = (uint32_t)filled.index(nx, ny);
+            if (visited[neighbour])
+                continue;
+
+            visited[neighbour] = 1;
+            downstream[neighbour] = (int32_t)cell; // where it was reached from, kept for flats
+            if (filled[neighbour] <= level)
+            {
+                filled[neighbour] = level;
+                pit.push(neighbour);
+            }
+            else
+            {
+                open.push(OpenCell(filled[neighbour], neighbour));
+            }
+        }
+    }
+}
+
+// Steepest descent on the filled surface. Levels come out of the flood in non-decreasing order,
+// so a strictly lower neighbour was always visited first and the order stays topological.
+void Hydrology::routeFlow()
+{
+    for (uint32_t cell : order)
+    {
+        const int x = (int)(cell % width);
+        const int y = (int)(cell / width);
+        const float level = filled[cell];
+        float steepest = 0.0f;
+        for (int k = 0; k < 8; k++)
+        {
+            const int nx = x + NEIGHBOUR_DX[k];
+            const int ny = y + NEIGHBOUR_DY[k];
+            if (!filled.inBounds(nx, ny))
+                continue;
+            const float slope = (level - filled(nx, ny)) / NEIGHBOUR_DISTANCE[k];
+            if (slope > steepest)
+            {
+                steepest = slope;
+                downstream[cell] = (int32_t)filled.index(nx, ny);
+            }
+        }
+    }
+}
+
+void Hydrology::accumulateFlow()
+{
+    accumulation.resize(width, height, 0);
+    for (uint32_t cell : order)
+    {
+        accumulation[cell] = 1;
+    }
+    for (size_t i = order.size(); i-- > 0;)
+    {
+        const uint32_t cell = order[i];
+        const int32_t target = downstream[cell];
+        if (target >= 0)
+            accumulation[target] += accumulation[cell];
+    }
+}
+
+void Hydrology::classify(const Grid2D<float> &elevation)
+{
+    water.resize(width, height, Water::SEA);
+    for (uint32_t cell : order)
+    {
+        if (filled[cell] - elevation[cell] >= params.lakeDepth)
+            water[cell] = Water::LAKE;
+        else if (accumulation[cell] >= (uint32_t)params.riverThreshold)
+            water[cell] = Water::RIVER;
+        else
+            water[cell] = Water::LAND;
+    }
+}
\ No newline at end of file
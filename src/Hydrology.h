@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "Grid2D.h"
+
+// Surface drainage over the whole map in one pass. Priority-flood (Barnes et al.) raises every
+// depression to its spill level, visiting cells from the coast inwards in order of that level.
+// Each land cell then drains to its steepest lower neighbour on the filled surface (D8), or across
+// flats towards the cell it was reached from. The visiting order is therefore a topological order
+// of the drainage tree, so flow accumulates in a single reverse sweep.
+class Hydrology
+{
+public:
+    struct Parameters
+    {
+        float seaLevel = 0.0f;     // cells below are sea; rivers end there
+        int riverThreshold = 300;  // cells draining through a cell that make it a river
+        float lakeDepth = 0.01f;   // filled depth at which a depression cell counts as lake
+    };
+
+    enum class Water : uint8_t
+    {
+        LAND,
+        SEA,
+        LAKE,
+        RIVER
+    };
+
+private:
+    Parameters params;
+
+    int width = 0;
+    int height = 0;
+    Grid2D<float> filled;          // elevation with depressions filled to their spill level
+    Grid2D<int32_t> downstream;    // index of the cell this one drains into; -1 for sea and the map edge
+    Grid2D<uint32_t> accumulation; // land cells draining through this one, itself included
+    Grid2D<Water> water;
+    std::vector<uint32_t> order;   // land cells, every cell after the one it drains into
+
+    void fillDepressions(const Grid2D<float> &elevation);
+    void routeFlow();
+    void accumulateFlow();
+    void classify(const Grid2D<float> &elevation);
+
+public:
+    void run(const Grid2D<float> &elevation);
+
+    // A map without drainage: no flow, and every cell LAND
+    void clear(int mapWidth, int mapHeight);
+
+    Parameters &getParameters() { return params; }
+    const Parameters &getParameters() const { return params; }
+
+    const Grid2D<float> &getFilledElevation() const { return filled; }
+    const Grid2D<int32_t> &getDownstream() const { return downstream; }
+    const Grid2D<uint32_t> &getAccumulation() const { return accumulation; }
+    const Grid2D<Water> &getWaterMap() const { return water; }
+};
\ No newline at end of file
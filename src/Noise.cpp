@@ -0,0 +1,305 @@
+#include "Noise.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GENESIS_NOISE_AVX2
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define GENESIS_NOISE_SSE41
+#endif
+
+// NOTE: the target is compiled with floating-point contraction disabled (see CMakeLists.txt)
+// so the batch kernels and the scalar reference round identically.
+
+namespace
+{
+    const float HASH_SCALE = 1.0f / 1073741824.0f;
+
+    inline uint32_t hashBits(int x, int y, uint32_t seedTerm)
+    {
+        uint32_t n = (uint32_t)x + (uint32_t)y * 57u + seedTerm;
+        n = (n << 13) ^ n;
+        return (n * (n * n * 15731u + 789221u) + 1376312589u) & 0x7fffffffu;
+    }
+
+    inline float hashToFloat(uint32_t bits)
+    {
+        return 1.0f - (float)(int32_t)bits * HASH_SCALE;
+    }
+
+    inline float smoothstep(float t)
+    {
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    // Portable row kernel; also handles the tails of the SIMD kernels
+    void accumulateRowScalar(float *out, int x0, int count, float y, float frequency, float amplitude, int seed)
+    {
+        const uint32_t seedTerm = (uint32_t)seed * 131u;
+        const float sampleY = y * frequency;
+        const int yi = (int)std::floor(sampleY);
+        const float sy = smoothstep(sampleY - yi);
+
+        for (int i = 0; i < count; i++)
+        {
+            float sampleX = (float)(x0 + i) * frequency;
+            int xi = (int)std::floor(sampleX);
+            float sx = smoothstep(sampleX - xi);
+
+            float v00 = hashToFloat(hashBits(xi, yi, seedTerm));
+            float v10 = hashToFloat(hashBits(xi + 1, yi, seedTerm));
+            float v01 = hashToFloat(hashBits(xi, yi + 1, seedTerm));
+            float v11 = hashToFloat(hashBits(xi + 1, yi + 1, seedTerm));
+
+            float a = v00 * (1.0f - sx) + v10 * sx;
+            float b = v01 * (1.0f - sx) + v11 * sx;
+
+            out[i] += (a * (1.0f - sy) + b * sy) * amplitude;
+        }
+    }
+
+#if defined(GENESIS_NOISE_AVX2)
+    inline __m256 hash8(__m256i x, __m256i y, __m256i seedTerm)
+    {
+        __m256i n = _mm256_add_epi32(_mm256_add_epi32(x, _mm256_mullo_epi32(y, _mm256_set1_epi32(57))), seedTerm);
+        n = _mm256_xor_si256(_mm256_slli_epi32(n, 13), n);
+
+        __m256i t = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_mullo_epi32(n, n), _mm256_set1_epi32(15731)),
+                                     _mm256_set1_epi32(789221));
+        t = _mm256_add_epi32(_mm256_mullo_epi32(n, t), _mm256_set1_epi32(1376312589));
+        t = _mm256_and_si256(t, _mm256_set1_epi32(0x7fffffff));
+
+        __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(t), _mm256_set1_ps(HASH_SCALE));
+        return _mm256_sub_ps(_mm256_set1_ps(1.0f), f);
+    }
+
+    void accumulateRowSIMD(float *out, int x0, int count, float y, float frequency, float amplitude, int seed, bool exact)
+    {
+        const float sampleY = y * frequency;
+        const int yi = (int)std::floor(sampleY);
+        const float sy = smoothstep(sampleY - yi);
+
+        const __m256i seedTerm = _mm256_set1_epi32((int)((uint32_t)seed * 131u));
+        const __m256i row0 = _mm256_set1_epi32(yi);
+        const __m256i row1 = _mm256_set1_epi32(yi + 1);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256 ones = _mm256_set1_ps(1.0f);
+        const __m256 vsy = _mm256_set1_ps(sy);
+        const __m256 vsyInv = _mm256_set1_ps(1.0f - sy);
+        const __m256 vfreq = _mm256_set1_ps(frequency);
+        const __m256 vamp = _mm256_set1_ps(amplitude);
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i px = _mm256_add_epi32(_mm256_set1_epi32(x0 + i), lanes);
+            __m256 sampleX = _mm256_mul_ps(_mm256_cvtepi32_ps(px), vfreq);
+            __m256 cell = _mm256_floor_ps(sampleX);
+            __m256i xi = _mm256_cvttps_epi32(cell);
+            __m256i xi1 = _mm256_add_epi32(xi, one);
+
+            __m256 xf = _mm256_sub_ps(sampleX, cell);
+            __m256 sx = _mm256_mul_ps(_mm256_mul_ps(xf, xf),
+                                      _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_set1_ps(2.0f), xf)));
+            __m256 sxInv = _mm256_sub_ps(ones, sx);
+
+            __m256 v00 = hash8(xi, row0, seedTerm);
+            __m256 v10 = hash8(xi1, row0, seedTerm);
+            __m256 v01 = hash8(xi, row1, seedTerm);
+            __m256 v11 = hash8(xi1, row1, seedTerm);
+
+            __m256 acc = _mm256_loadu_ps(out + i);
+#if defined(__FMA__)
+            if (!exact)
+            {
+                __m256 a = _mm256_fmadd_ps(v10, sx, _mm256_mul_ps(v00, sxInv));
+                __m256 b = _mm256_fmadd_ps(v11, sx, _mm256_mul_ps(v01, sxInv));
+                __m256 n = _mm256_fmadd_ps(b, vsy, _mm256_mul_ps(a, vsyInv));
+                _mm256_storeu_ps(out + i, _mm256_fmadd_ps(n, vamp, acc));
+                continue;
+            }
+#endif
+            __m256 a = _mm256_add_ps(_mm256_mul_ps(v00, sxInv), _mm256_mul_ps(v10, sx));
+            __m256 b = _mm256_add_ps(_mm256_mul_ps(v01, sxInv), _mm256_mul_ps(v11, sx));
+            __m256 n = _mm256_add_ps(_mm256_mul_ps(a, vsyInv), _mm256_mul_ps(b, vsy));
+            _mm256_storeu_ps(out + i, _mm256_add_ps(acc, _mm256_mul_ps(n, vamp)));
+        }
+
+        accumulateRowScalar(out + i, x0 + i, count - i, y, frequency, amplitude, seed);
+    }
+#elif defined(GENESIS_NOISE_SSE41)
+    inline __m128 hash4(__m128i x, __m128i y, __m128i seedTerm)
+    {
+        __m128i n = _mm_add_epi32(_mm_add_epi32(x, _mm_mullo_epi32(y, _mm_set1_epi32(57))), seedTerm);
+        n = _mm_xor_si128(_mm_slli_epi32(n, 13), n);
+
+        __m128i t = _mm_add_epi32(_mm_mullo_epi32(_mm_mullo_epi32(n, n), _mm_set1_epi32(15731)),
+                                  _mm_set1_epi32(789221));
+        t = _mm_add_epi32(_mm_mullo_epi32(n, t), _mm_set1_epi32(1376312589));
+        t = _mm_and_si128(t, _mm_set1_epi32(0x7fffffff));
+
+        __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(t), _mm_set1_ps(HASH_SCALE));
+        return _mm_sub_ps(_mm_set1_ps(1.0f), f);
+    }
+
+    void accumulateRowSIMD(float *out, int x0, int count, float y, float frequency, float amplitude, int seed, bool exact)
+    {
+        // SSE4.1 has no fused multiply-add, so both modes are exact here
+        (void)exact;
+
+        const float sampleY = y * frequency;
+        const int yi = (int)std::floor(sampleY);
+        const float sy = smoothstep(sampleY - yi);
+
+        const __m128i seedTerm = _mm_set1_epi32((int)((uint32_t)seed * 131u));
+        const __m128i row0 = _mm_set1_epi32(yi);
+        const __m128i row1 = _mm_set1_epi32(yi + 1);
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128 ones = _mm_set1_ps(1.0f);
+        const __m128 vsy = _mm_set1_ps(sy);
+        const __m128 vsyInv = _mm_set1_ps(1.0f - sy);
+        const __m128 vfreq = _mm_set1_ps(frequency);
+        const __m128 vamp = _mm_set1_ps(amplitude);
+
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i px = _mm_add_epi32(_mm_set1_epi32(x0 + i), lanes);
+            __m128 sampleX = _mm_mul_ps(_mm_cvtepi32_ps(px), vfreq);
+            __m128 cell = _mm_floor_ps(sampleX);
+            __m128i xi = _mm_cvttps_epi32(cell);
+            __m128i xi1 = _mm_add_epi32(xi, one);
+
+            __m128 xf = _mm_sub_ps(sampleX, cell);
+            __m128 sx = _mm_mul_ps(_mm_mul_ps(xf, xf),
+                                   _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), xf)));
+            __m128 sxInv = _mm_sub_ps(ones, sx);
+
+            __m128 v00 = hash4(xi, row0, seedTerm);
+            __m128 v10 = hash4(xi1, row0, seedTerm);
+            __m128 v01 = hash4(xi, row1, seedTerm);
+            __m128 v11 = hash4(xi1, row1, seedTerm);
+
+            __m128 a = _mm_add_ps(_mm_mul_ps(v00, sxInv), _mm_mul_ps(v10, sx));
+            __m128 b = _mm_add_ps(_mm_mul_ps(v01, sxInv), _mm_mul_ps(v11, sx));
+            __m128 n = _mm_add_ps(_mm_mul_ps(a, vsyInv), _mm_mul_ps(b, vsy));
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(n, vamp)));
+        }
+
+        accumulateRowScalar(out + i, x0 + i, count - i, y, frequency, amplitude, seed);
+    }
+#endif
+}
+
+namespace Noise
+{
+    float hash(int x, int y, int seed)
+    {
+        return hashToFloat(hashBits(x, y, (uint32_t)seed * 131u));
+    }
+
+    float valueNoise(float x, float y, int seed)
+    {
+        int xi = (int)std::floor(x);
+        int yi = (int)std::floor(y);
+
+        float xf = x - xi;
+        float yf = y - yi;
+
+        // Get corner values
+        float v00 = hash(xi, yi, seed);
+        float v10 = hash(xi + 1, yi, seed);
+        float v01 = hash(xi, yi + 1, seed);
+        float v11 = hash(xi + 1, yi + 1, seed);
+
+        // Interpolate
+        float sx = smoothstep(xf);
+        float sy = smoothstep(yf);
+
+        float a = v00 * (1.0f - sx) + v10 * sx;
+        float b = v01 * (1.0f - sx) + v11 * sx;
+
+        return a * (1.0f - sy) + b * sy;
+    }
+
+    void accumulateRow(float *out, int x0, int count, float y, float frequency, float amplitude, int seed, bool exact)
+    {
+#if defined(GENESIS_NOISE_AVX2) || defined(GENESIS_NOISE_SSE41)
+        accumulateRowSIMD(out, x0, count, y, frequency, amplitude, seed, exact);
+#else
+        (void)exact;
+        accumulateRowScalar(out, x0, count, y, frequency, amplitude, seed);
+#endif
+    }
+
+    const char *kernelName()
+    {
+#if defined(GENESIS_NOISE_AVX2)
+        return "AVX2";
+#elif defined(GENESIS_NOISE_SSE41)
+        return "SSE4.1";
+#else
+        return "scalar";
+#endif
+    }
+
+    void OctaveLattice::build(int x0, int y0, int width, int height, float freq, int seed)
+    {
+        frequency = freq;
+        pixelCount = width;
+
+        // Lattice cells touched by the rectangle, plus the +1 corner of the last cell
+        originX = (int)std::floor((float)x0 * freq);
+        originY = (int)std::floor((float)y0 * freq);
+        columns = (int)std::floor((float)(x0 + width - 1) * freq) - originX + 2;
+        rows = (int)std::floor((float)(y0 + height - 1) * freq) - originY + 2;
+
+        const uint32_t seedTerm = (uint32_t)seed * 131u;
+        values.resize((size_t)columns * rows);
+        for (int ly = 0; ly < rows; ly++)
+        {
+            float *row = values.data() + (size_t)ly * columns;
+            for (int lx = 0; lx < columns; lx++)
+            {
+                row[lx] = hashToFloat(hashBits(originX + lx, originY + ly, seedTerm));
+            }
+        }
+
+        cellIndex.resize(width);
+        weightX.resize(width);
+        for (int i = 0; i < width; i++)
+        {
+            float sampleX = (float)(x0 + i) * freq;
+            int xi = (int)std::floor(sampleX);
+            cellIndex[i] = xi - originX;
+            weightX[i] = smoothstep(sampleX - xi);
+        }
+    }
+
+    void OctaveLattice::accumulateRow(float *out, int y, float amplitude) const
+    {
+        const float sampleY = (float)y * frequency;
+        const int yi = (int)std::floor(sampleY);
+        const float sy = smoothstep(sampleY - yi);
+        const float syInv = 1.0f - sy;
+
+        const float *row0 = values.data() + (size_t)(yi - originY) * columns;
+        const float *row1 = row0 + columns;
+        const int *cells = cellIndex.data();
+        const float *weights = weightX.data();
+
+        for (int i = 0; i < pixelCount; i++)
+        {
+            int c = cells[i];
+            float sx = weights[i];
+
+            float a = row0[c] * (1.0f - sx) + row0[c + 1] * sx;
+            float b = row1[c] * (1.0f - sx) + row1[c + 1] * sx;
+
+            out[i] += (a * syInv + b * sy) * amplitude;
+        }
+    }
+}
\ No newline at end of file
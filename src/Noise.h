@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Value noise shared by world generation and rendering.
+// The batch kernels evaluate whole rows with AVX2 or SSE4.1 when the build enables them,
+// and fall back to a portable loop otherwise.
+namespace Noise
+{
+    // Lattice hash in [-1, 1]. Unsigned arithmetic gives the same values the old
+    // signed-overflow hash produced, without relying on undefined behaviour.
+    float hash(int x, int y, int seed);
+
+    // Scalar reference: smoothstep-interpolated value noise at (x, y)
+    float valueNoise(float x, float y, int seed);
+
+    // Adds amplitude * valueNoise((x0 + i) * frequency, y * frequency, seed) to out[i] for i in [0, count).
+    // With exact = true the result is bit-identical to the scalar reference; otherwise
+    // the kernel may use fused multiply-add where the CPU supports it.
+    void accumulateRow(float *out, int x0, int count, float y, float frequency, float amplitude, int seed, bool exact);
+
+    // Name of the instruction set the batch kernel was compiled for
+    const char *kernelName();
+
+    // One octave's lattice corner values over a pixel rectangle, hashed once up front.
+    // Rows are then interpolated from the table, so hashing cost scales with lattice
+    // points instead of pixels. Output is bit-identical to valueNoise.
+    class OctaveLattice
+    {
+    private:
+        float frequency = 0.0f;
+        int originX = 0; // first lattice column / row held in the table
+        int originY = 0;
+        int columns = 0;
+        int rows = 0;
+        int pixelCount = 0;
+
+        std::vector<float> values;  // columns x rows corner values
+        std::vector<int> cellIndex; // per pixel column: lattice column - originX
+        std::vector<float> weightX; // per pixel column: smoothstep of the x fraction
+
+    public:
+        // Covers pixels [x0, x0 + width) x [y0, y0 + height)
+        void build(int x0, int y0, int width, int height, float frequency, int seed);
+
+        // Adds amplitude * noise for pixel row y (absolute coordinates) to out[0..width)
+        void accumulateRow(float *out, int y, float amplitude) const;
+
+        // Lattice points are only worth caching while cells span more than one pixel
+        static bool worthCaching(float frequency) { return frequency < 1.0f; }
+    };
+}
\ No newline at end of file
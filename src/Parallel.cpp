@@ -0,0 +1,65 @@
+#include "Parallel.h"
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+namespace
+{
+    int requestedThreads = 0;
+}
+
+namespace Parallel
+{
+    void setThreadCount(int count)
+    {
+        requestedThreads = std::max(0, count);
+    }
+
+    int getThreadCount()
+    {
+        if (requestedThreads > 0)
+            return requestedThreads;
+
+        unsigned int hardware = std::thread::hardware_concurrency();
+        return hardware > 0 ? (int)hardware : 1;
+    }
+
+    void forEachChunk(int count, int chunkSize, const std::function<void(int, int, int)> &fn)
+    {
+        const int chunks = chunkCount(count, chunkSize);
+        const int threads = std::min(getThreadCount(), chunks);
+
+        if (threads <= 1)
+        {
+            for (int chunk = 0; chunk < chunks; chunk++)
+            {
+                fn(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+            }
+            return;
+        }
+
+        // Threads pull chunks from a shared counter; which thread runs a chunk does not affect its result
+        std::atomic<int> next(0);
+        auto worker = [&]()
+        {
+            for (int chunk = next++; chunk < chunks; chunk = next++)
+            {
+                fn(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (int i = 1; i < threads; i++)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+
+        for (auto &thread : pool)
+        {
+            thread.join();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <functional>
+
+// Minimal fork-join helpers for full-map passes.
+// Work is split into fixed-size chunks that depend only on the problem size, never on the
+// thread count, so per-chunk reductions combined in chunk order give identical results
+// for any number of threads.
+namespace Parallel
+{
+    // 0 = one thread per hardware core
+    void setThreadCount(int count);
+    int getThreadCount();
+
+    inline int chunkCount(int count, int chunkSize) { return (count + chunkSize - 1) / chunkSize; }
+
+    // Runs fn(begin, end, chunkIndex) for every chunk of [0, count)
+    void forEachChunk(int count, int chunkSize, const std::function<void(int, int, int)> &fn);
+
+    // Row bands used by the map passes
+    const int ROW_BAND = 16;
+}
\ No newline at end of file
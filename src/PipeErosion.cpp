@@ -0,0 +1,314 @@
+#include "PipeErosion.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GENESIS_PIPE_AVX2
+#endif
+
+// Fields are padded by one cell; these return the first interior cell of interior row y
+static inline float *interiorRow(Grid2D<float> &grid, int y) { return grid.row(y + 1) + 1; }
+static inline const float *interiorRow(const Grid2D<float> &grid, int y) { return grid.row(y + 1) + 1; }
+
+void PipeErosion::reset(const Grid2D<float> &elevation)
+{
+    width = elevation.getWidth();
+    height = elevation.getHeight();
+    current = 0;
+
+    const int paddedWidth = width + 2;
+    const int paddedHeight = height + 2;
+    for (Grid2D<float> *field : {&terrain[0], &terrain[1], &sediment[0], &sediment[1], &water, &fluxLeft, &fluxRight,
+                                 &fluxUp, &fluxDown, &velocityX, &velocityY})
+    {
+        field->resize(paddedWidth, paddedHeight, 0.0f);
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        std::copy(elevation.row(y), elevation.row(y) + width, interiorRow(terrain[0], y));
+    }
+    replicateBorders();
+}
+
+void PipeErosion::replicateBorders()
+{
+    for (Grid2D<float> *field : {&terrain[current], &water})
+    {
+        Grid2D<float> &grid = *field;
+        for (int y = 1; y <= height; y++)
+        {
+            grid(0, y) = grid(1, y);
+            grid(width + 1, y) = grid(width, y);
+        }
+        std::copy(grid.row(1), grid.row(1) + width + 2, grid.row(0));
+        std::copy(grid.row(height), grid.row(height) + width + 2, grid.row(height + 1));
+    }
+}
+
+// Outflow through each pipe accelerates with the drop in water surface towards that neighbour,
+// then all four are scaled down together so a cell never sends out more water than it holds
+void PipeErosion::updateFlux()
+{
+    const float acceleration = params.timeStep * params.gravity;
+    const float timeStep = params.timeStep;
+    const int stride = width + 2;
+    const Grid2D<float> &ground = terrain[current];
+
+    auto fluxBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const float *b = interiorRow(ground, y);
+            const float *d = interiorRow(water, y);
+            float *left = interiorRow(fluxLeft, y);
+            float *right = interiorRow(fluxRight, y);
+            float *up = interiorRow(fluxUp, y);
+            float *down = interiorRow(fluxDown, y);
+
+            int x = 0;
+#if defined(GENESIS_PIPE_AVX2)
+            // Same operations in the same order as the scalar loop below
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 tiny = _mm256_set1_ps(1e-12f);
+            const __m256 vAcceleration = _mm256_set1_ps(acceleration);
+            const __m256 vTimeStep = _mm256_set1_ps(timeStep);
+            for (; x + 8 <= width; x += 8)
+            {
+                const __m256 depth = _mm256_loadu_ps(d + x);
+                const __m256 surface = _mm256_add_ps(_mm256_loadu_ps(b + x), depth);
+                auto outflow = [&](const float *flux, int offset)
+                {
+                    __m256 drop = _mm256_sub_ps(_mm256_sub_ps(surface, _mm256_loadu_ps(b + x + offset)), _mm256_loadu_ps(d + x + offset));
+                    return _mm256_max_ps(_mm256_add_ps(_mm256_loadu_ps(flux + x), _mm256_mul_ps(vAcceleration, drop)), zero);
+                };
+                const __m256 outLeft = outflow(left, -1);
+                const __m256 outRight = outflow(right, 1);
+                const __m256 outUp = outflow(up, -stride);
+                const __m256 outDown = outflow(down, stride);
+
+                const __m256 total = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(outLeft, outRight), outUp), outDown), vTimeStep);
+                const __m256 scale = _mm256_min_ps(_mm256_div_ps(depth, _mm256_max_ps(total, tiny)), one);
+
+                _mm256_storeu_ps(left + x, _mm256_mul_ps(outLeft, scale));
+                _mm256_storeu_ps(right + x, _mm256_mul_ps(outRight, scale));
+                _mm256_storeu_ps(up + x, _mm256_mul_ps(outUp, scale));
+                _mm256_storeu_ps(down + x, _mm256_mul_ps(outDown, scale));
+            }
+#endif
+            for (; x < width; x++)
+            {
+                const float surface = b[x] + d[x];
+                float outLeft = std::max(0.0f, left[x] + acceleration * (surface - b[x - 1] - d[x - 1]));
+                float outRight = std::max(0.0f, right[x] + acceleration * (surface - b[x + 1] - d[x + 1]));
+                float outUp = std::max(0.0f, up[x] + acceleration * (surface - b[x - stride] - d[x - stride]));
+                float outDown = std::max(0.0f, down[x] + acceleration * (surface - b[x + stride] - d[x + stride]));
+
+                const float total = (outLeft + outRight + outUp + outDown) * timeStep;
+                const float scale = std::min(1.0f, d[x] / std::max(total, 1e-12f));
+
+                left[x] = outLeft * scale;
+                right[x] = outRight * scale;
+                up[x] = outUp * scale;
+                down[x] = outDown * scale;
+            }
+        }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, fluxBand);
+}
+
+// Moves water by the net flux, derives the flow velocity and dissolves or deposits sediment
+// towards the capacity of that flow. Terrain is read from one buffer and written to the other
+// because the slope looks at the neighbours.
+void PipeErosion::updateWaterAndErode()
+{
+    const float timeStep = params.timeStep;
+    const int stride = width + 2;
+    const Grid2D<float> &ground = terrain[current];
+    Grid2D<float> &nextGround = terrain[1 - current];
+
+    auto erodeBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const float *b = interiorRow(ground, y);
+            float *bNext = interiorRow(nextGround, y);
+            float *d = interiorRow(water, y);
+            float *s = interiorRow(sediment[0], y);
+            const float *left = interiorRow(fluxLeft, y);
+            const float *right = interiorRow(fluxRight, y);
+            const float *up = interiorRow(fluxUp, y);
+            const float *down = interiorRow(fluxDown, y);
+            float *u = interiorRow(velocityX, y);
+            float *v = interiorRow(velocityY, y);
+
+            int x = 0;
+#if defined(GENESIS_PIPE_AVX2)
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 minusOne = _mm256_set1_ps(-1.0f);
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 minDepth = _mm256_set1_ps(1e-4f);
+            const __m256 vTimeStep = _mm256_set1_ps(timeStep);
+            const __m256 vMinTilt = _mm256_set1_ps(params.minTilt);
+            const __m256 vCapacity = _mm256_set1_ps(params.sedimentCapacity);
+            const __m256 vDissolving = _mm256_set1_ps(params.dissolving);
+            const __m256 vDepositing = _mm256_set1_ps(params.depositing);
+            for (; x + 8 <= width; x += 8)
+            {
+                auto at = [&](const float *field, int offset) { return _mm256_loadu_ps(field + x + offset); };
+
+                const __m256 inflow = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(at(right, -1), at(left, 1)), at(down, -stride)), at(up, stride));
+                const __m256 outflow = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(at(left, 0), at(right, 0)), at(up, 0)), at(down, 0));
+                const __m256 oldDepth = at(d, 0);
+                const __m256 newDepth = _mm256_max_ps(_mm256_add_ps(oldDepth, _mm256_mul_ps(vTimeStep, _mm256_sub_ps(inflow, outflow))), zero);
+                _mm256_storeu_ps(d + x, newDepth);
+
+                const __m256 meanDepth = _mm256_max_ps(_mm256_mul_ps(_mm256_add_ps(oldDepth, newDepth), half), minDepth);
+                const __m256 flowX = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(at(right, -1), at(left, 0)), _mm256_sub_ps(at(right, 0), at(left, 1))), half);
+                const __m256 flowY = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(at(down, -stride), at(up, 0)), _mm256_sub_ps(at(down, 0), at(up, stride))), half);
+                const __m256 velX = _mm256_div_ps(flowX, meanDepth);
+                const __m256 velY = _mm256_div_ps(flowY, meanDepth);
+                _mm256_storeu_ps(u + x, velX);
+                _mm256_storeu_ps(v + x, velY);
+
+                const __m256 slopeX = _mm256_mul_ps(_mm256_sub_ps(at(b, 1), at(b, -1)), half);
+                const __m256 slopeY = _mm256_mul_ps(_mm256_sub_ps(at(b, stride), at(b, -stride)), half);
+                const __m256 slopeSquared = _mm256_add_ps(_mm256_mul_ps(slopeX, slopeX), _mm256_mul_ps(slopeY, slopeY));
+                const __m256 sinTilt = _mm256_max_ps(_mm256_sqrt_ps(_mm256_div_ps(slopeSquared, _mm256_add_ps(one, slopeSquared))), vMinTilt);
+                const __m256 speed = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(velX, velX), _mm256_mul_ps(velY, velY)));
+                const __m256 capacity = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(vCapacity, sinTilt), speed), newDepth);
+
+                const __m256 load = at(s, 0);
+                const __m256 missing = _mm256_sub_ps(capacity, load);
+                const __m256 exchange = _mm256_blendv_ps(_mm256_mul_ps(vDepositing, missing), _mm256_mul_ps(vDissolving, missing),
+                                                         _mm256_cmp_ps(missing, zero, _CMP_GT_OQ));
+
+                const __m256 ground = at(b, 0);
+                const __m256 eroded = _mm256_max_ps(_mm256_min_ps(_mm256_sub_ps(ground, exchange), one), minusOne);
+                _mm256_storeu_ps(s + x, _mm256_add_ps(load, _mm256_sub_ps(ground, eroded)));
+                _mm256_storeu_ps(bNext + x, eroded);
+            }
+#endif
+            for (; x < width; x++)
+            {
+                const float inflow = right[x - 1] + left[x + 1] + down[x - stride] + up[x + stride];
+                const float outflow = left[x] + right[x] + up[x] + down[x];
+                const float oldDepth = d[x];
+                const float newDepth = std::max(0.0f, oldDepth + timeStep * (inflow - outflow));
+                d[x] = newDepth;
+
+                // Flow through the cell, divided by the mean depth; very shallow films are treated as still
+                const float meanDepth = std::max((oldDepth + newDepth) * 0.5f, 1e-4f);
+                const float flowX = ((right[x - 1] - left[x]) + (right[x] - left[x + 1])) * 0.5f;
+                const float flowY = ((down[x - stride] - up[x]) + (down[x] - up[x + stride])) * 0.5f;
+                u[x] = flowX / meanDepth;
+                v[x] = flowY / meanDepth;
+
+                const float slopeX = (b[x + 1] - b[x - 1]) * 0.5f;
+                const float slopeY = (b[x + stride] - b[x - stride]) * 0.5f;
+                const float slopeSquared = slopeX * slopeX + slopeY * slopeY;
+                const float sinTilt = std::max(params.minTilt, std::sqrt(slopeSquared / (1.0f + slopeSquared)));
+                const float speed = std::sqrt(u[x] * u[x] + v[x] * v[x]);
+                const float capacity = params.sedimentCapacity * sinTilt * speed * newDepth;
+
+                // Positive: dissolve part of the missing load, negative: drop part of the excess
+                const float missing = capacity - s[x];
+                const float exchange = missing > 0.0f ? params.dissolving * missing : params.depositing * missing;
+
+                const float eroded = std::max(-1.0f, std::min(1.0f, b[x] - exchange));
+                s[x] += b[x] - eroded;
+                bNext[x] = eroded;
+            }
+        }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, erodeBand);
+    current = 1 - current;
+}
+
+// Carries sediment along the velocity field (semi-Lagrangian: each cell fetches the load from
+// where its water came from), then evaporates, drains the sea and rains for the next step
+void PipeErosion::transportSediment()
+{
+    const float timeStep = params.timeStep;
+    const float evaporationFactor = std::max(0.0f, 1.0f - params.evaporation * timeStep);
+    const float rain = params.rainRate * timeStep;
+    const float maxX = (float)(width - 1);
+    const float maxY = (float)(height - 1);
+    Grid2D<float> &ground = terrain[current];
+
+    auto transportBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const float *u = interiorRow(velocityX, y);
+            const float *v = interiorRow(velocityY, y);
+            float *b = interiorRow(ground, y);
+            float *d = interiorRow(water, y);
+            float *s = interiorRow(sediment[1], y);
+
+            for (int x = 0; x < width; x++)
+            {
+                const float fromX = std::max(0.0f, std::min(maxX, x - u[x] * timeStep));
+                const float fromY = std::max(0.0f, std::min(maxY, y - v[x] * timeStep));
+                const int cellX = std::min((int)fromX, width - 2);
+                const int cellY = std::min((int)fromY, height - 2);
+                const float fx = fromX - cellX;
+                const float fy = fromY - cellY;
+
+                const float *row0 = interiorRow(sediment[0], cellY) + cellX;
+                const float *row1 = interiorRow(sediment[0], cellY + 1) + cellX;
+                float load = row0[0] * (1 - fx) * (1 - fy) + row0[1] * fx * (1 - fy) + row1[0] * (1 - fx) * fy + row1[1] * fx * fy;
+
+                if (b[x] < params.seaLevel)
+                {
+                    // The sea floor takes the load, filling up to sea level at most
+                    b[x] = std::min(params.seaLevel, b[x] + load);
+                    load = 0.0f;
+                    d[x] = 0.0f;
+                }
+                else
+                {
+                    d[x] = d[x] * evaporationFactor + rain;
+                }
+                s[x] = load;
+            }
+        }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, transportBand);
+    std::swap(sediment[0], sediment[1]);
+}
+
+void PipeErosion::run(Grid2D<float> &elevation, bool verbose)
+{
+    if (elevation.getWidth() < 2 || elevation.getHeight() < 2)
+    {
+        return;
+    }
+
+    reset(elevation);
+
+    const int progressInterval = params.iterations / 10;
+    for (int iteration = 0; iteration < params.iterations; iteration++)
+    {
+        updateFlux();
+        updateWaterAndErode();
+        transportSediment();
+        replicateBorders();
+
+        if (verbose && progressInterval > 0 && iteration % progressInterval == 0)
+        {
+            std::cout << "Erosion progress: " << (iteration * 100 / params.iterations) << "%" << std::endl;
+        }
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        const float *row = interiorRow(terrain[current], y);
+        std::copy(row, row + width, elevation.row(y));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Grid2D.h"
+
+// Grid-based hydraulic erosion after the virtual-pipe shallow-water model. Rain fills a water
+// layer on land. Water flows to the four neighbours through virtual pipes, and the resulting
+// flow speed decides how much sediment each cell dissolves or deposits. Suspended sediment is
+// carried along with the flow, and water reaching the sea drops its load there and drains away.
+// Every pass is a stencil over the whole map, so the cost per iteration is fixed and the result
+// does not depend on the thread count.
+class PipeErosion
+{
+public:
+    struct Parameters
+    {
+        int iterations = 150;
+        float timeStep = 0.05f;
+        float rainRate = 0.02f;     // water added to every land cell per unit of time
+        float gravity = 9.81f;      // pipe cross-section folded in
+        float sedimentCapacity = 0.5f;
+        float dissolving = 0.3f;    // fraction of the missing load picked up per step
+        float depositing = 0.3f;    // fraction of the excess load dropped per step
+        float evaporation = 0.05f;  // fraction of the water lost per unit of time
+        float minTilt = 0.005f;     // keeps some carrying capacity on flat ground
+        float seaLevel = 0.0f;      // cells below drain their water and keep its sediment
+    };
+
+private:
+    Parameters params;
+
+    // All fields carry a one-cell border so the stencils need no edge cases. Terrain and water
+    // borders replicate the edge cells, so no water flows off the map, and flux borders stay zero.
+    int width = 0;
+    int height = 0;
+    Grid2D<float> terrain[2]; // ping-pong: the update pass reads one and writes the other
+    Grid2D<float> sediment[2]; // ping-pong: transport reads one and writes the other
+    Grid2D<float> water;
+    Grid2D<float> fluxLeft, fluxRight, fluxUp, fluxDown;
+    Grid2D<float> velocityX, velocityY;
+    int current = 0;
+
+    void reset(const Grid2D<float> &elevation);
+    void updateFlux();
+    void updateWaterAndErode();
+    void transportSediment();
+    void replicateBorders();
+
+public:
+    // Erodes the elevation map in place, with values kept in [-1, 1]
+    void run(Grid2D<float> &elevation, bool verbose);
+
+    Parameters &getParameters() { return params; }
+    const Parameters &getParameters() const { return params; }
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// Counter-based random numbers. Every item (a droplet, a city name) gets its own
+// short stream derived from (world seed, subsystem, item index) alone, so items can be drawn on
+// any thread and in any order with identical results.
+namespace Random
+{
+    // One key space per consumer, so subsystems never share values
+    enum class Subsystem : uint32_t
+    {
+        EROSION_DROPLETS = 1,
+        CHUNK_DROPLETS = 2,
+        CITY_NAMES = 4
+    };
+
+    // SplitMix64 output function
+    inline uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // SplitMix64 stream for one item; successive calls give the item's successive values
+    class Generator
+    {
+    private:
+        uint64_t state;
+
+    public:
+        Generator(uint32_t seed, Subsystem subsystem, uint64_t index)
+            : state(mix(mix(((uint64_t)seed << 32) | (uint32_t)subsystem) + index)) {}
+
+        uint64_t next()
+        {
+            state += 0x9E3779B97F4A7C15ull;
+            return mix(state);
+        }
+
+        // Uniform in [0, 1), from the top 24 bits
+        float nextFloat() { return (float)(next() >> 40) * (1.0f / 16777216.0f); }
+
+        // Uniform in [0, bound) for bound > 0 (multiply-shift; the bias is below 2^-32)
+        int nextInt(int bound) { return (int)(((next() >> 32) * (uint64_t)bound) >> 32); }
+    };
+}
\ No newline at end of file
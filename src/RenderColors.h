@@ -0,0 +1,66 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "World.h"
+#include "Climate.h"
+
+// Display colours for the SFML viewer; the simulation core never needs them
+struct TerrainColor
+{
+    static sf::Color getColor(TerrainType type)
+    {
+        switch (type)
+        {
+        case TerrainType::DEEP_WATER:
+            return sf::Color(0, 50, 120);
+        case TerrainType::SHALLOW_WATER:
+            return sf::Color(20, 100, 180);
+        case TerrainType::SAND:
+            return sf::Color(238, 203, 173);
+        case TerrainType::GRASS:
+            return sf::Color(86, 152, 23);
+        case TerrainType::FOREST:
+            return sf::Color(34, 100, 34);
+        case TerrainType::ROCK:
+            return sf::Color(130, 130, 130);
+        case TerrainType::SNOW:
+            return sf::Color(255, 255, 255);
+        }
+        return sf::Color::Black;
+    }
+};
+
+struct BiomeColor
+{
+    static sf::Color getColor(BiomeType type)
+    {
+        switch (type)
+        {
+        case BiomeType::OCEAN:
+            return sf::Color(0, 50, 120);
+        case BiomeType::ICE:
+            return sf::Color(240, 248, 255);
+        case BiomeType::TUNDRA:
+            return sf::Color(196, 204, 187);
+        case BiomeType::TAIGA:
+            return sf::Color(0, 100, 0);
+        case BiomeType::TEMPERATE_FOREST:
+            return sf::Color(34, 139, 34);
+        case BiomeType::TEMPERATE_GRASSLAND:
+            return sf::Color(154, 205, 50);
+        case BiomeType::DESERT:
+            return sf::Color(238, 203, 173);
+        case BiomeType::SAVANNA:
+            return sf::Color(209, 186, 116);
+        case BiomeType::TROPICAL_FOREST:
+            return sf::Color(0, 128, 0);
+        case BiomeType::BEACH:
+            return sf::Color(238, 214, 175);
+        case BiomeType::LAKE:
+            return sf::Color(100, 149, 237);
+        case BiomeType::RIVER:
+            return sf::Color(65, 105, 225);
+        }
+        return sf::Color::Black;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "ShardedGenerator.h"
+#include "World.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <vector>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GENESIS_HAVE_FORK 1
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+bool ShardedGenerator::isSupported()
+{
+#ifdef GENESIS_HAVE_FORK
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef GENESIS_HAVE_FORK
+
+void ShardedGenerator::generate(World &world, int processes)
+{
+    const int width = world.getWidth();
+    const int height = world.getHeight();
+    const int bands = Parallel::chunkCount(height, Parallel::ROW_BAND);
+    processes = std::min(processes, bands);
+
+    if (processes <= 1)
+    {
+        world.generate();
+        return;
+    }
+
+    // Segment layout: elevation rows, terrain rows, then noise and final statistics per band
+    const size_t cells = (size_t)width * height;
+    const size_t elevationBytes = cells * sizeof(float);
+    const size_t terrainBytes = cells * sizeof(TerrainType);
+    const size_t statsOffset = (elevationBytes + terrainBytes + alignof(ElevationStats) - 1) / alignof(ElevationStats) * alignof(ElevationStats);
+    const size_t segmentBytes = statsOffset + 2 * bands * sizeof(ElevationStats);
+
+    void *segment = mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (segment == MAP_FAILED)
+    {
+        std::cerr << "Sharded generation: could not map shared memory, generating in-process" << std::endl;
+        world.generate();
+        return;
+    }
+
+    char *base = static_cast<char *>(segment);
+    float *elevation = reinterpret_cast<float *>(base);
+    TerrainType *terrain = reinterpret_cast<TerrainType *>(base + elevationBytes);
+    ElevationStats *noiseStats = reinterpret_cast<ElevationStats *>(base + statsOffset);
+    ElevationStats *finalStats = noiseStats + bands;
+    std::fill(noiseStats, noiseStats + 2 * bands, ElevationStats());
+
+    // Computed once here; the workers inherit the cached field through fork
+    world.prefetchFalloff();
+
+    const int threadsPerWorker = std::max(1, Parallel::getThreadCount() / processes);
+    std::cout.flush();
+
+    std::vector<pid_t> workers;
+    for (int shard = 0; shard < processes; shard++)
+    {
+        // Shards are whole row bands, so band statistics line up with World::generate()
+        const int y0 = std::min(height, (int)((long long)bands * shard / processes) * Parallel::ROW_BAND);
+        const int y1 = std::min(height, (int)((long long)bands * (shard + 1) / processes) * Parallel::ROW_BAND);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            Parallel::setThreadCount(threadsPerWorker);
+            world.generateRows(y0, y1, elevation + (size_t)y0 * width, terrain + (size_t)y0 * width,
+                               noiseStats, finalStats);
+            _exit(0);
+        }
+        if (pid < 0)
+        {
+            break;
+        }
+        workers.push_back(pid);
+    }
+
+    bool succeeded = (int)workers.size() == processes;
+    for (pid_t pid : workers)
+    {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            succeeded = false;
+        }
+    }
+
+    if (!succeeded)
+    {
+        std::cerr << "Sharded generation: a worker failed, generating in-process" << std::endl;
+        munmap(segment, segmentBytes);
+        world.generate();
+        return;
+    }
+
+    // Stitch the bands into the world and merge statistics in band order
+    float *worldElevation = world.getElevationMap().data();
+    TerrainType *worldTerrain = world.getTerrainMap().data();
+    auto copyBand = [&](int by0, int by1, int)
+    {
+        std::copy(elevation + (size_t)by0 * width, elevation + (size_t)by1 * width, worldElevation + (size_t)by0 * width);
+        std::copy(terrain + (size_t)by0 * width, terrain + (size_t)by1 * width, worldTerrain + (size_t)by0 * width);
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, copyBand);
+
+    world.finishGeneration(std::vector<ElevationStats>(noiseStats, noiseStats + bands),
+                           std::vector<ElevationStats>(finalStats, finalStats + bands));
+
+    munmap(segment, segmentBytes);
+}
+
+#else
+
+void ShardedGenerator::generate(World &world, int processes)
+{
+    if (processes > 1)
+    {
+        std::cerr << "Sharded generation needs fork(); generating in-process" << std::endl;
+    }
+    world.generate();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+class World;
+
+// Generates one world with several worker processes on the same machine. Each worker forks
+// from the caller, generates a band of rows (noise, falloff, terrain types) straight into a
+// shared memory segment and exits; the caller then stitches the bands into the world and
+// merges the per-band statistics in order, so the result is bit-identical to World::generate().
+// Every worker touches only its own band's pages first, which keeps them on its NUMA node.
+class ShardedGenerator
+{
+public:
+    // Falls back to world.generate() for one process, on platforms without fork(),
+    // or if the shared segment or any worker fails
+    static void generate(World &world, int processes);
+
+    static bool isSupported();
+};
\ No newline at end of file
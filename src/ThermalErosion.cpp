@@ -0,0 +1,185 @@
+#include "ThermalErosion.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GENESIS_THERMAL_AVX2
+#endif
+
+namespace
+{
+    // The eight neighbours, with their distance in cells
+    const int NEIGHBOUR_DX[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    const int NEIGHBOUR_DY[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    const float NEIGHBOUR_DISTANCE[8] = {1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.0f, 1.41421356f, 1.0f, 1.41421356f};
+
+    inline float *interiorRow(Grid2D<float> &grid, int y) { return grid.row(y + 1) + 1; }
+    inline const float *interiorRow(const Grid2D<float> &grid, int y) { return grid.row(y + 1) + 1; }
+}
+
+// Every cell works out how much it sheds this sweep: rate/2 of its largest excess over the
+// talus slope (half, so two cells meet at the talus slope rather than swap places), shared
+// among all neighbours it exceeds the slope towards in proportion to the drop
+void ThermalErosion::computeOutflow()
+{
+    const int stride = width + 2;
+    const float halfRate = params.rate * 0.5f;
+    int offsets[8];
+    float thresholds[8];
+    for (int k = 0; k < 8; k++)
+    {
+        offsets[k] = NEIGHBOUR_DY[k] * stride + NEIGHBOUR_DX[k];
+        thresholds[k] = params.talus * NEIGHBOUR_DISTANCE[k];
+    }
+    const Grid2D<float> &source = heights[current];
+
+    auto outflowBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const float *h = interiorRow(source, y);
+            float *share = interiorRow(shareFactor, y);
+            float *out = interiorRow(outflow, y);
+
+            int x = 0;
+#if defined(GENESIS_THERMAL_AVX2)
+            // Same operations in the same order as the scalar loop below
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 tiny = _mm256_set1_ps(1e-12f);
+            const __m256 vHalfRate = _mm256_set1_ps(halfRate);
+            for (; x + 8 <= width; x += 8)
+            {
+                const __m256 centre = _mm256_loadu_ps(h + x);
+                __m256 total = zero;
+                __m256 excess = zero;
+                for (int k = 0; k < 8; k++)
+                {
+                    const __m256 drop = _mm256_sub_ps(centre, _mm256_loadu_ps(h + x + offsets[k]));
+                    const __m256 over = _mm256_sub_ps(drop, _mm256_set1_ps(thresholds[k]));
+                    total = _mm256_add_ps(total, _mm256_and_ps(_mm256_cmp_ps(over, zero, _CMP_GT_OQ), drop));
+                    excess = _mm256_max_ps(over, excess);
+                }
+                const __m256 factor = _mm256_div_ps(_mm256_mul_ps(vHalfRate, excess), _mm256_max_ps(total, tiny));
+                _mm256_storeu_ps(share + x, factor);
+                _mm256_storeu_ps(out + x, _mm256_mul_ps(factor, total));
+            }
+#endif
+            for (; x < width; x++)
+            {
+                float total = 0.0f;
+                float excess = 0.0f;
+                for (int k = 0; k < 8; k++)
+                {
+                    const float drop = h[x] - h[x + offsets[k]];
+                    const float over = drop - thresholds[k];
+                    total += over > 0.0f ? drop : 0.0f;
+                    excess = std::max(excess, over);
+                }
+                const float factor = halfRate * excess / std::max(total, 1e-12f);
+                share[x] = factor;
+                out[x] = factor * total;
+            }
+        }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, outflowBand);
+}
+
+// Every cell loses what it sheds and gathers its share from each higher neighbour. A neighbour
+// sends to this cell exactly when this cell passed its talus test, so no material is created or lost.
+// The wall around the map never passes it and sends nothing, as its share factor stays 0.
+void ThermalErosion::applyTransfers()
+{
+    const int stride = width + 2;
+    int offsets[8];
+    float thresholds[8];
+    for (int k = 0; k < 8; k++)
+    {
+        offsets[k] = NEIGHBOUR_DY[k] * stride + NEIGHBOUR_DX[k];
+        thresholds[k] = params.talus * NEIGHBOUR_DISTANCE[k];
+    }
+    const Grid2D<float> &source = heights[current];
+    Grid2D<float> &target = heights[1 - current];
+
+    auto transferBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const float *h = interiorRow(source, y);
+            const float *share = interiorRow(shareFactor, y);
+            const float *out = interiorRow(outflow, y);
+            float *next = interiorRow(target, y);
+
+            int x = 0;
+#if defined(GENESIS_THERMAL_AVX2)
+            for (; x + 8 <= width; x += 8)
+            {
+                const __m256 centre = _mm256_loadu_ps(h + x);
+                __m256 result = _mm256_sub_ps(centre, _mm256_loadu_ps(out + x));
+                for (int k = 0; k < 8; k++)
+                {
+                    const __m256 rise = _mm256_sub_ps(_mm256_loadu_ps(h + x + offsets[k]), centre);
+                    const __m256 received = _mm256_mul_ps(_mm256_loadu_ps(share + x + offsets[k]), rise);
+                    const __m256 sends = _mm256_cmp_ps(rise, _mm256_set1_ps(thresholds[k]), _CMP_GT_OQ);
+                    result = _mm256_add_ps(result, _mm256_and_ps(sends, received));
+                }
+                _mm256_storeu_ps(next + x, result);
+            }
+#endif
+            for (; x < width; x++)
+            {
+                float result = h[x] - out[x];
+                for (int k = 0; k < 8; k++)
+                {
+                    const float rise = h[x + offsets[k]] - h[x];
+                    result += rise > thresholds[k] ? share[x + offsets[k]] * rise : 0.0f;
+                }
+                next[x] = result;
+            }
+        }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, transferBand);
+    current = 1 - current;
+}
+
+void ThermalErosion::run(Grid2D<float> &elevation, bool verbose)
+{
+    width = elevation.getWidth();
+    height = elevation.getHeight();
+    current = 0;
+
+    // Finite, so the wall's zero share times its rise stays 0 rather than NaN
+    const float wall = std::numeric_limits<float>::max();
+    for (Grid2D<float> *field : {&heights[0], &heights[1]})
+    {
+        field->resize(width + 2, height + 2, wall);
+    }
+    for (Grid2D<float> *field : {&shareFactor, &outflow})
+    {
+        field->resize(width + 2, height + 2, 0.0f);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        std::copy(elevation.row(y), elevation.row(y) + width, interiorRow(heights[0], y));
+    }
+
+    if (verbose)
+    {
+        std::cout << "Thermal erosion: " << params.iterations << " sweeps at talus " << params.talus << std::endl;
+    }
+
+    for (int iteration = 0; iteration < params.iterations; iteration++)
+    {
+        computeOutflow();
+        applyTransfers();
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        const float *row = interiorRow(heights[current], y);
+        std::copy(row, row + width, elevation.row(y));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Grid2D.h"
+
+// Thermal (talus) erosion: wherever the drop to a neighbour exceeds the talus slope, part of
+// the excess material slides down, shared among the lower neighbours in proportion to the drop.
+// Each sweep reads one height buffer and writes the other, so cells can be updated in any
+// order and in parallel. The result does not depend on the thread count.
+class ThermalErosion
+{
+public:
+    struct Parameters
+    {
+        int iterations = 8;
+        float talus = 0.02f;    // steepest stable drop per cell (diagonals scaled by their length)
+        float rate = 0.5f;      // fraction of the excess moved per sweep; 1 settles it in one step
+    };
+
+private:
+    Parameters params;
+
+    // Padded by one cell of wall higher than any terrain, so the stencil needs no edge cases and
+    // material never slides off the map
+    int width = 0;
+    int height = 0;
+    Grid2D<float> heights[2];
+    Grid2D<float> shareFactor; // material sent per unit of drop to each lower neighbour
+    Grid2D<float> outflow;     // total material a cell sends away this sweep
+    int current = 0;
+
+    void computeOutflow();
+    void applyTransfers();
+
+public:
+    // Relaxes the elevation map in place
+    void run(Grid2D<float> &elevation, bool verbose);
+
+    Parameters &getParameters() { return params; }
+    const Parameters &getParameters() const { return params; }
+};
\ No newline at end of file
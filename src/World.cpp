@@ -1,82 +1,160 @@
 #include "World.h"
+#include "Noise.h"
+#include "Parallel.h"
+#include "FalloffCache.h"
 #include <cmath>
 #include <algorithm>
 #include <random>
 #include <iostream>
 
-// Simple hash function for procedural generation
-static float hash(int x, int y, int seed)
+void ElevationStats::addRow(const float *row, int count, float landThreshold)
 {
-    int n = x + y * 57 + seed * 131;
-    n = (n << 13) ^ n;
-    return (1.0f - ((n * (n * n * 15731 + 789221) + 1376312589) & 0x7fffffff) / 1073741824.0f);
+    for (int x = 0; x < count; x++)
+    {
+        minElevation = std::min(minElevation, row[x]);
+        maxElevation = std::max(maxElevation, row[x]);
+        if (row[x] > landThreshold)
+            landTiles++;
+    }
 }
 
-// Smooth interpolation
-static float smoothstep(float t)
+ElevationStats ElevationStats::merge(const std::vector<ElevationStats> &parts)
 {
-    return t * t * (3.0f - 2.0f * t);
+    // Combined in band order so the result never depends on which thread ran which band
+    ElevationStats total;
+    for (const ElevationStats &part : parts)
+    {
+        total.minElevation = std::min(total.minElevation, part.minElevation);
+        total.maxElevation = std::max(total.maxElevation, part.maxElevation);
+        total.landTiles += part.landTiles;
+    }
+    return total;
 }
 
-// 2D Perlin-style noise implementation
-static float noise2D(float x, float y, int seed)
+World::World(int width, int height, int tileSize, int seed)
+    : width(width), height(height), tileSize(tileSize), seed(seed), worldWidth(width), worldHeight(height)
 {
-    int xi = (int)std::floor(x);
-    int yi = (int)std::floor(y);
 
-    float xf = x - xi;
-    float yf = y - yi;
+    // Initialize elevation map
+    elevationMap.resize(width, height, 0.0f);
+    terrainTypes.resize(width, height, TerrainType::DEEP_WATER);
+}
 
-    // Get corner values
-    float v00 = hash(xi, yi, seed);
-    float v10 = hash(xi + 1, yi, seed);
-    float v01 = hash(xi, yi + 1, seed);
-    float v11 = hash(xi + 1, yi + 1, seed);
+float World::generateOctaveNoise(float x, float y)
+{
+    float value = 0.0f;
+    float amplitude = 1.0f;
+    float freq = frequency;
+    float maxValue = 0.0f;
 
-    // Interpolate
-    float sx = smoothstep(xf);
-    float sy = smoothstep(yf);
+    for (int i = 0; i < octaves; i++)
+    {
+        value += Noise::valueNoise(x * freq, y * freq, seed + i) * amplitude;
+        maxValue += amplitude;
 
-    float a = v00 * (1.0f - sx) + v10 * sx;
-    float b = v01 * (1.0f - sx) + v11 * sx;
+        amplitude *= persistence;
+        freq *= lacunarity;
+    }
 
-    return a * (1.0f - sy) + b * sy;
+    // Normalize to [-1, 1]
+    return value / maxValue;
 }
 
-World::World(int width, int height, int tileSize, int seed)
-    : width(width), height(height), tileSize(tileSize), seed(seed)
+void World::buildOctaveLattices(std::vector<Noise::OctaveLattice> &lattices, int x0, int y0, int w, int h)
 {
+    lattices.clear();
+    if (noiseKernel != NoiseKernel::LATTICE)
+        return;
 
-    // Initialize elevation map
-    elevationMap.resize(height, std::vector<float>(width, 0.0f));
-    terrainTypes.resize(height, std::vector<TerrainType>(width, TerrainType::DEEP_WATER));
+    // Octaves with sub-pixel cells gain nothing from caching and use the batch kernel instead
+    float freq = frequency;
+    for (int i = 0; i < octaves && Noise::OctaveLattice::worthCaching(freq); i++)
+    {
+        lattices.emplace_back();
+        lattices.back().build(x0, y0, w, h, freq, seed + i);
+        freq *= lacunarity;
+    }
 }
 
-float World::generateOctaveNoise(float x, float y)
+void World::generateNoiseRow(int x0, int y, int count, float *row, const std::vector<Noise::OctaveLattice> &lattices)
 {
-    float value = 0.0f;
+    const bool exact = noiseKernel != NoiseKernel::BATCH_FAST;
     float amplitude = 1.0f;
     float freq = frequency;
     float maxValue = 0.0f;
 
+    std::fill(row, row + count, 0.0f);
+
+    // Same octave order as generateOctaveNoise, so exact modes match it bit for bit
     for (int i = 0; i < octaves; i++)
     {
-        value += noise2D(x * freq, y * freq, seed + i) * amplitude;
+        if (i < (int)lattices.size())
+        {
+            lattices[i].accumulateRow(row, y, amplitude);
+        }
+        else
+        {
+            Noise::accumulateRow(row, x0, count, (float)y, freq, amplitude, seed + i, exact);
+        }
         maxValue += amplitude;
 
         amplitude *= persistence;
         freq *= lacunarity;
     }
 
-    // Normalize to [-1, 1]
-    return value / maxValue;
+    for (int x = 0; x < count; x++)
+    {
+        row[x] = row[x] / maxValue;
+    }
 }
 
-float World::calculateFalloff(float x, float y)
+// The lattices must have been built for columns [x0, x0 + w) and rows covering [y0, y0 + h).
+// falloff, when given, is the cached field for the whole map; otherwise falloff is evaluated per pixel.
+void World::generateTile(int x0, int y0, int w, int h, float *elevation, TerrainType *terrain, int stride,
+                         const std::vector<Noise::OctaveLattice> &lattices, const Grid2D<float> *falloff,
+                         ElevationStats &noiseStats, ElevationStats &finalStats)
+{
+    for (int ty = 0; ty < h; ty++)
+    {
+        const int y = y0 + ty;
+        float *row = elevation + (size_t)ty * stride;
+        TerrainType *terrainRow = terrain + (size_t)ty * stride;
+
+        if (noiseKernel == NoiseKernel::REFERENCE)
+        {
+            for (int tx = 0; tx < w; tx++)
+            {
+                row[tx] = generateOctaveNoise(x0 + tx, y);
+            }
+        }
+        else
+        {
+            generateNoiseRow(x0, y, w, row, lattices);
+        }
+        noiseStats.addRow(row, w, thresholds.sand);
+
+        // Same arithmetic as applyFalloffMap and assignTerrainTypes, while the row is still in cache
+        const float *falloffRow = falloff ? falloff->row(y) + x0 : nullptr;
+        for (int tx = 0; tx < w; tx++)
+        {
+            const int x = x0 + tx;
+            float falloffValue = falloffRow ? falloffRow[tx] : calculateFalloffAt(x, y);
+
+            float value = row[tx] + falloffValue - 0.5f;
+            value = std::max(-1.0f, std::min(1.0f, value));
+
+            row[tx] = value;
+            terrainRow[tx] = getTerrainType(value);
+        }
+        finalStats.addRow(row, w, thresholds.sand);
+    }
+}
+
+float World::calculateFalloff(float x, float y) const
 {
     // Normalize coordinates to [-1, 1]
-    float nx = (x / (float)width) * 2.0f - 1.0f;
-    float ny = (y / (float)height) * 2.0f - 1.0f;
+    float nx = (x / (float)worldWidth) * 2.0f - 1.0f;
+    float ny = (y / (float)worldHeight) * 2.0f - 1.0f;
 
     // Use the maximum of x and y distance for a square-ish island
     float distance = std::max(std::abs(nx), std::abs(ny));
@@ -91,10 +169,10 @@ float World::calculateFalloff(float x, float y)
             std::pow(islandFalloffB - islandFalloffB * value, islandFalloffA));
 }
 
-float World::calculateArchipelagoFalloff(float x, float y)
+float World::calculateArchipelagoFalloff(float x, float y) const
 {
-    float nx = (x / (float)width) * 2.0f - 1.0f;
-    float ny = (y / (float)height) * 2.0f - 1.0f;
+    float nx = (x / (float)worldWidth) * 2.0f - 1.0f;
+    float ny = (y / (float)worldHeight) * 2.0f - 1.0f;
 
     // Multiple island centers with different sizes and strengths
     // Main island
@@ -122,62 +200,218 @@ float World::calculateArchipelagoFalloff(float x, float y)
             std::pow(islandFalloffB - islandFalloffB * value, islandFalloffA));
 }
 
+void World::generate()
+{
+    // The falloff field is fetched inside generateRows; bands are merged in order afterwards
+    const int bands = Parallel::chunkCount(height, Parallel::ROW_BAND);
+    std::vector<ElevationStats> noiseStats(bands);
+    std::vector<ElevationStats> finalStats(bands);
+
+    generateRows(0, height, elevationMap.data(), terrainTypes.data(), noiseStats.data(), finalStats.data());
+    finishGeneration(noiseStats, finalStats);
+}
+
+void World::generateRows(int y0, int y1, float *elevation, TerrainType *terrain,
+                         ElevationStats *noiseStats, ElevationStats *finalStats)
+{
+    std::vector<Noise::OctaveLattice> lattices;
+    buildOctaveLattices(lattices, originX, originY + y0, width, y1 - y0);
+
+    // The cached field only exists for whole worlds; regions evaluate falloff per pixel
+    std::shared_ptr<const Grid2D<float>> falloff;
+    if (coversWholeWorld())
+    {
+        falloff = getFalloffField();
+    }
+
+    const int firstBand = y0 / Parallel::ROW_BAND;
+    auto generateBand = [&](int by0, int by1, int band)
+    {
+        generateTile(originX, originY + y0 + by0, width, by1 - by0, elevation + (size_t)by0 * width,
+                     terrain + (size_t)by0 * width, width, lattices, falloff.get(),
+                     noiseStats[firstBand + band], finalStats[firstBand + band]);
+    };
+    Parallel::forEachChunk(y1 - y0, Parallel::ROW_BAND, generateBand);
+}
+
+void World::finishGeneration(const std::vector<ElevationStats> &noiseStats, const std::vector<ElevationStats> &finalStats)
+{
+    ElevationStats noise = ElevationStats::merge(noiseStats);
+    generationStats = ElevationStats::merge(finalStats);
+    rebuildLandIndex();
+
+    if (verbose)
+    {
+        float landPercentage = (generationStats.landTiles * 100.0f) / (width * height);
+        std::cout << "Noise range before falloff: [" << noise.minElevation << ", " << noise.maxElevation << "]" << std::endl;
+        std::cout << "Final elevation range: [" << generationStats.minElevation << ", " << generationStats.maxElevation << "]" << std::endl;
+        std::cout << "Land coverage: " << landPercentage << "%" << std::endl;
+    }
+}
+
+WorldRegion World::generateRegion(int x0, int y0, int w, int h)
+{
+    WorldRegion region;
+    region.originX = std::max(0, x0);
+    region.originY = std::max(0, y0);
+    const int regionWidth = std::max(0, std::min(worldWidth, x0 + w) - region.originX);
+    const int regionHeight = std::max(0, std::min(worldHeight, y0 + h) - region.originY);
+    region.elevation.resize(regionWidth, regionHeight, 0.0f);
+    region.terrain.resize(regionWidth, regionHeight, TerrainType::DEEP_WATER);
+    if (regionWidth == 0 || regionHeight == 0)
+    {
+        return region;
+    }
+
+    std::vector<Noise::OctaveLattice> lattices;
+    buildOctaveLattices(lattices, region.originX, region.originY, regionWidth, regionHeight);
+
+    // Falloff is evaluated per pixel: a small viewport should not pay for the whole-world field
+    const int bands = Parallel::chunkCount(regionHeight, Parallel::ROW_BAND);
+    std::vector<ElevationStats> noiseStats(bands);
+    std::vector<ElevationStats> finalStats(bands);
+
+    auto generateBand = [&](int by0, int by1, int band)
+    {
+        generateTile(region.originX, region.originY + by0, regionWidth, by1 - by0,
+                     region.elevation.row(by0), region.terrain.row(by0), regionWidth,
+                     lattices, nullptr, noiseStats[band], finalStats[band]);
+    };
+    Parallel::forEachChunk(regionHeight, Parallel::ROW_BAND, generateBand);
+
+    region.stats = ElevationStats::merge(finalStats);
+    return region;
+}
+
 void World::generateNoiseMap()
 {
     // Generate base noise
-    float minElev = 1.0f, maxElev = -1.0f;
+    std::vector<Noise::OctaveLattice> lattices;
+    buildOctaveLattices(lattices, originX, originY, width, height);
 
-    for (int y = 0; y < height; y++)
+    std::vector<ElevationStats> bandStats(Parallel::chunkCount(height, Parallel::ROW_BAND));
+    auto generateBand = [&](int y0, int y1, int band)
     {
-        for (int x = 0; x < width; x++)
+        ElevationStats &stats = bandStats[band];
+        for (int y = y0; y < y1; y++)
         {
-            elevationMap[y][x] = generateOctaveNoise(x, y);
-            minElev = std::min(minElev, elevationMap[y][x]);
-            maxElev = std::max(maxElev, elevationMap[y][x]);
+            float *row = elevationMap.row(y);
+
+            if (noiseKernel == NoiseKernel::REFERENCE)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    row[x] = generateOctaveNoise(originX + x, originY + y);
+                }
+            }
+            else
+            {
+                generateNoiseRow(originX, originY + y, width, row, lattices);
+            }
+
+            stats.addRow(row, width, thresholds.sand);
         }
-    }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, generateBand);
 
-    std::cout << "Noise range before falloff: [" << minElev << ", " << maxElev << "]" << std::endl;
+    ElevationStats noiseStats = ElevationStats::merge(bandStats);
+    if (verbose)
+        std::cout << "Noise range before falloff: [" << noiseStats.minElevation << ", " << noiseStats.maxElevation << "]" << std::endl;
 
     // Apply island falloff
     applyFalloffMap();
 
     // Check final range
-    minElev = 1.0f;
-    maxElev = -1.0f;
-    int landTiles = 0;
-    for (int y = 0; y < height; y++)
+    std::fill(bandStats.begin(), bandStats.end(), ElevationStats());
+    auto statsBand = [&](int y0, int y1, int band)
     {
-        for (int x = 0; x < width; x++)
+        for (int y = y0; y < y1; y++)
         {
-            minElev = std::min(minElev, elevationMap[y][x]);
-            maxElev = std::max(maxElev, elevationMap[y][x]);
-            if (elevationMap[y][x] > thresholds.sand)
-                landTiles++;
+            bandStats[band].addRow(elevationMap.row(y), width, thresholds.sand);
         }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, statsBand);
+
+    generationStats = ElevationStats::merge(bandStats);
+    if (verbose)
+    {
+        float landPercentage = (generationStats.landTiles * 100.0f) / (width * height);
+        std::cout << "Final elevation range: [" << generationStats.minElevation << ", " << generationStats.maxElevation << "]" << std::endl;
+        std::cout << "Land coverage: " << landPercentage << "%" << std::endl;
     }
+}
 
-    float landPercentage = (landTiles * 100.0f) / (width * height);
-    std::cout << "Final elevation range: [" << minElev << ", " << maxElev << "]" << std::endl;
-    std::cout << "Land coverage: " << landPercentage << "%" << std::endl;
+float World::calculateFalloffAt(int worldX, int worldY) const
+{
+    return (islandMode == IslandMode::ARCHIPELAGO) ? calculateArchipelagoFalloff(worldX, worldY) : calculateFalloff(worldX, worldY);
+}
+
+std::shared_ptr<const Grid2D<float>> World::getFalloffField() const
+{
+    FalloffCache::Key key{width, height, (int)islandMode, islandFalloffA, islandFalloffB};
+
+    auto compute = [this](Grid2D<float> &field)
+    {
+        auto computeBand = [&](int y0, int y1, int)
+        {
+            for (int y = y0; y < y1; y++)
+            {
+                float *row = field.row(y);
+                for (int x = 0; x < width; x++)
+                {
+                    row[x] = calculateFalloffAt(x, y);
+                }
+            }
+        };
+        Parallel::forEachChunk(height, Parallel::ROW_BAND, computeBand);
+    };
+
+    return FalloffCache::get(key, compute);
+}
+
+void World::prefetchFalloff() const
+{
+    if (coversWholeWorld())
+    {
+        getFalloffField();
+    }
 }
 
 void World::applyFalloffMap()
 {
-    for (int y = 0; y < height; y++)
+    std::shared_ptr<const Grid2D<float>> falloff;
+    if (coversWholeWorld())
+    {
+        falloff = getFalloffField();
+    }
+
+    auto applyBand = [&](int y0, int y1, int)
     {
-        for (int x = 0; x < width; x++)
+        for (int y = y0; y < y1; y++)
         {
-            float falloff = (islandMode == IslandMode::ARCHIPELAGO) ? calculateArchipelagoFalloff(x, y) : calculateFalloff(x, y);
+            float *row = elevationMap.row(y);
+            for (int x = 0; x < width; x++)
+            {
+                float falloffValue = falloff ? (*falloff)(x, y) : calculateFalloffAt(originX + x, originY + y);
 
-            // Blend the noise with the falloff
-            // The falloff should make edges go to water (-1) and center stay high
-            elevationMap[y][x] = elevationMap[y][x] + falloff - 0.5f;
+                // Blend the noise with the falloff
+                // The falloff should make edges go to water (-1) and center stay high
+                row[x] = row[x] + falloffValue - 0.5f;
 
-            // Clamp to valid range
-            elevationMap[y][x] = std::max(-1.0f, std::min(1.0f, elevationMap[y][x]));
+                // Clamp to valid range
+                row[x] = std::max(-1.0f, std::min(1.0f, row[x]));
+            }
         }
-    }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, applyBand);
+}
+
+void World::setRegion(int regionOriginX, int regionOriginY, int regionWorldWidth, int regionWorldHeight)
+{
+    originX = regionOriginX;
+    originY = regionOriginY;
+    worldWidth = regionWorldWidth;
+    worldHeight = regionWorldHeight;
 }
 
 TerrainType World::getTerrainType(float elevation)
@@ -199,113 +433,130 @@ TerrainType World::getTerrainType(float elevation)
 
 void World::assignTerrainTypes()
 {
-    for (int y = 0; y < height; y++)
+    auto classifyBand = [&](int y0, int y1, int)
     {
-        for (int x = 0; x < width; x++)
+        for (int y = y0; y < y1; y++)
         {
-            terrainTypes[y][x] = getTerrainType(elevationMap[y][x]);
+            const float *elevation = elevationMap.row(y);
+            TerrainType *terrain = terrainTypes.row(y);
+            for (int x = 0; x < width; x++)
+            {
+                terrain[x] = getTerrainType(elevation[x]);
+            }
         }
-    }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, classifyBand);
+    rebuildLandIndex();
 }
 
-void World::render(sf::RenderWindow &window)
+void World::rebuildLandIndex()
 {
-    // Use vertex array for efficient rendering
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
-
-    for (int y = 0; y < height; y++)
+    // Count per row, then fill each row's slice; rows are independent once their starts are known
+    landIndex.rowStart.assign(height + 1, 0);
+    auto countBand = [&](int y0, int y1, int)
     {
-        for (int x = 0; x < width; x++)
+        for (int y = y0; y < y1; y++)
         {
-            int index = (y * width + x) * 6;
-
-            // Define quad corners
-            float left = x * tileSize;
-            float top = y * tileSize;
-            float right = left + tileSize;
-            float bottom = top + tileSize;
-
-            // Get terrain color with slight variation for visual interest
-            sf::Color baseColor = TerrainColor::getColor(terrainTypes[y][x]);
-
-            // Add subtle noise to the color for texture
-            int variation = (int)(hash(x, y, seed * 7) * 10) - 5;
-            sf::Color color(
-                std::max(0, std::min(255, baseColor.r + variation)),
-                std::max(0, std::min(255, baseColor.g + variation)),
-                std::max(0, std::min(255, baseColor.b + variation)));
-
-            // Create two triangles for the quad
-            // Triangle 1
-            vertices[index + 0].position = sf::Vector2f(left, top);
-            vertices[index + 1].position = sf::Vector2f(right, top);
-            vertices[index + 2].position = sf::Vector2f(left, bottom);
-
-            // Triangle 2
-            vertices[index + 3].position = sf::Vector2f(right, top);
-            vertices[index + 4].position = sf::Vector2f(right, bottom);
-            vertices[index + 5].position = sf::Vector2f(left, bottom);
-
-            // Set colors
-            for (int i = 0; i < 6; i++)
+            const TerrainType *terrain = terrainTypes.row(y);
+            uint32_t count = 0;
+            for (int x = 0; x < width; x++)
             {
-                vertices[index + i].color = color;
+                count += terrain[x] >= TerrainType::SAND;
             }
+            landIndex.rowStart[y + 1] = count;
         }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, countBand);
+
+    for (int y = 0; y < height; y++)
+    {
+        landIndex.rowStart[y + 1] += landIndex.rowStart[y];
     }
+    landIndex.cells.resize(landIndex.rowStart[height]);
 
-    window.draw(vertices);
+    auto fillBand = [&](int y0, int y1, int)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            const TerrainType *terrain = terrainTypes.row(y);
+            uint32_t *out = landIndex.cells.data() + landIndex.rowStart[y];
+            for (int x = 0; x < width; x++)
+            {
+                if (terrain[x] >= TerrainType::SAND)
+                    *out++ = (uint32_t)y * width + x;
+            }
+        }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, fillBand);
 }
 
-void World::renderHeightmap(sf::RenderWindow &window)
+void World::assignTerrainTypes(const GridRect &rect)
 {
-    // Render as grayscale heightmap
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+    const GridRect area = rect.clipped(width, height);
+    if (area.isEmpty())
+        return;
 
-    for (int y = 0; y < height; y++)
+    for (int y = area.y0; y < area.y1; y++)
     {
-        for (int x = 0; x < width; x++)
+        const float *elevation = elevationMap.row(y);
+        TerrainType *terrain = terrainTypes.row(y);
+        for (int x = area.x0; x < area.x1; x++)
         {
-            int index = (y * width + x) * 6;
-
-            // Define quad corners
-            float left = x * tileSize;
-            float top = y * tileSize;
-            float right = left + tileSize;
-            float bottom = top + tileSize;
-
-            // Convert elevation to grayscale (0-255)
-            float elevation = elevationMap[y][x];
-            int gray = (int)((elevation + 1.0f) * 0.5f * 255.0f);
-            gray = std::max(0, std::min(255, gray));
-
-            sf::Color color(gray, gray, gray);
-
-            // Create two triangles for the quad
-            vertices[index + 0].position = sf::Vector2f(left, top);
-            vertices[index + 1].position = sf::Vector2f(right, top);
-            vertices[index + 2].position = sf::Vector2f(left, bottom);
-
-            vertices[index + 3].position = sf::Vector2f(right, top);
-            vertices[index + 4].position = sf::Vector2f(right, bottom);
-            vertices[index + 5].position = sf::Vector2f(left, bottom);
+            terrain[x] = getTerrainType(elevation[x]);
+        }
+    }
+    updateLandIndex(area);
+}
 
-            // Set colors
-            for (int i = 0; i < 6; i++)
-            {
-                vertices[index + i].color = color;
-            }
+// Rebuilds the entries of the rows area spans: cells left and right of it are kept, the ones
+// inside rescanned, and the rest of the index shifted by the change in count
+void World::updateLandIndex(const GridRect &area)
+{
+    std::vector<uint32_t> rows;
+    std::vector<uint32_t> rowCounts(area.getHeight());
+    for (int y = area.y0; y < area.y1; y++)
+    {
+        const size_t before = rows.size();
+        const uint32_t *oldBegin = landIndex.cells.data() + landIndex.rowStart[y];
+        const uint32_t *oldEnd = landIndex.cells.data() + landIndex.rowStart[y + 1];
+        const uint32_t *left = std::lower_bound(oldBegin, oldEnd, (uint32_t)(y * width + area.x0));
+        const uint32_t *right = std::lower_bound(left, oldEnd, (uint32_t)(y * width + area.x1));
+
+        rows.insert(rows.end(), oldBegin, left);
+        const TerrainType *terrain = terrainTypes.row(y);
+        for (int x = area.x0; x < area.x1; x++)
+        {
+            if (terrain[x] >= TerrainType::SAND)
+                rows.push_back((uint32_t)(y * width + x));
         }
+        rows.insert(rows.end(), right, oldEnd);
+        rowCounts[y - area.y0] = (uint32_t)(rows.size() - before);
     }
 
-    window.draw(vertices);
+    const uint32_t begin = landIndex.rowStart[area.y0];
+    const uint32_t end = landIndex.rowStart[area.y1];
+    const long long shift = (long long)rows.size() - (long long)(end - begin);
+    if (shift > 0)
+        landIndex.cells.insert(landIndex.cells.begin() + end, (size_t)shift, 0u);
+    else if (shift < 0)
+        landIndex.cells.erase(landIndex.cells.begin() + (end + shift), landIndex.cells.begin() + end);
+    std::copy(rows.begin(), rows.end(), landIndex.cells.begin() + begin);
+
+    for (int y = area.y0; y < area.y1; y++)
+    {
+        landIndex.rowStart[y + 1] = landIndex.rowStart[y] + rowCounts[y - area.y0];
+    }
+    for (int y = area.y1 + 1; y <= height; y++)
+    {
+        landIndex.rowStart[y] = (uint32_t)(landIndex.rowStart[y] + shift);
+    }
 }
 
 float World::getElevation(int x, int y) const
 {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        return elevationMap[y][x];
+        return elevationMap(x, y);
     }
     return -1.0f; // Out of bounds
 }
@@ -314,7 +565,7 @@ TerrainType World::getTerrain(int x, int y) const
 {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        return terrainTypes[y][x];
+        return terrainTypes(x, y);
     }
     return TerrainType::DEEP_WATER; // Out of bounds
 }
@@ -323,37 +574,44 @@ void World::modifyElevation(int x, int y, float delta)
 {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        elevationMap[y][x] += delta;
+        elevationMap(x, y) += delta;
         // Keep elevation in reasonable bounds
-        elevationMap[y][x] = std::max(-1.0f, std::min(1.0f, elevationMap[y][x]));
+        elevationMap(x, y) = std::max(-1.0f, std::min(1.0f, elevationMap(x, y)));
     }
 }
 
 void World::normalizeElevation()
 {
     // Find min and max elevation
-    float minElev = elevationMap[0][0];
-    float maxElev = elevationMap[0][0];
-
-    for (int y = 0; y < height; y++)
+    std::vector<ElevationStats> bandStats(Parallel::chunkCount(height, Parallel::ROW_BAND));
+    auto rangeBand = [&](int y0, int y1, int band)
     {
-        for (int x = 0; x < width; x++)
+        for (int y = y0; y < y1; y++)
         {
-            minElev = std::min(minElev, elevationMap[y][x]);
-            maxElev = std::max(maxElev, elevationMap[y][x]);
+            bandStats[band].addRow(elevationMap.row(y), width, thresholds.sand);
         }
-    }
+    };
+    Parallel::forEachChunk(height, Parallel::ROW_BAND, rangeBand);
+
+    ElevationStats stats = ElevationStats::merge(bandStats);
+    float minElev = stats.minElevation;
+    float maxElev = stats.maxElevation;
 
     // Normalize to [-1, 1] range
     float range = maxElev - minElev;
     if (range > 0)
     {
-        for (int y = 0; y < height; y++)
+        auto normalizeBand = [&](int y0, int y1, int)
         {
-            for (int x = 0; x < width; x++)
+            for (int y = y0; y < y1; y++)
             {
-                elevationMap[y][x] = ((elevationMap[y][x] - minElev) / range) * 2.0f - 1.0f;
+                float *row = elevationMap.row(y);
+                for (int x = 0; x < width; x++)
+                {
+                    row[x] = ((row[x] - minElev) / range) * 2.0f - 1.0f;
+                }
             }
-        }
+        };
+        Parallel::forEachChunk(height, Parallel::ROW_BAND, normalizeBand);
     }
 }
\ No newline at end of file
@@ -1,7 +1,16 @@
 #pragma once
 
 #include <vector>
-#include <SFML/Graphics.hpp>
+#include <memory>
+#include <cstdint>
+#include "Grid2D.h"
+#include "Noise.h"
+
+// Rendering is implemented in the *Render.cpp files, which only the viewer builds
+namespace sf
+{
+    class RenderWindow;
+}
 
 enum class TerrainType
 {
@@ -14,29 +23,32 @@ enum class TerrainType
     SNOW
 };
 
-struct TerrainColor
+// Min/max/land-count reduction over (part of) an elevation map
+struct ElevationStats
 {
-    static sf::Color getColor(TerrainType type)
-    {
-        switch (type)
-        {
-        case TerrainType::DEEP_WATER:
-            return sf::Color(0, 50, 120);
-        case TerrainType::SHALLOW_WATER:
-            return sf::Color(20, 100, 180);
-        case TerrainType::SAND:
-            return sf::Color(238, 203, 173);
-        case TerrainType::GRASS:
-            return sf::Color(86, 152, 23);
-        case TerrainType::FOREST:
-            return sf::Color(34, 100, 34);
-        case TerrainType::ROCK:
-            return sf::Color(130, 130, 130);
-        case TerrainType::SNOW:
-            return sf::Color(255, 255, 255);
-        }
-        return sf::Color::Black;
-    }
+    float minElevation = 1.0f;
+    float maxElevation = -1.0f;
+    long long landTiles = 0;
+
+    void addRow(const float *row, int count, float landThreshold);
+    static ElevationStats merge(const std::vector<ElevationStats> &parts);
+};
+
+// Cells of a sub-rectangle of a world, addressed in world coordinates
+struct WorldRegion
+{
+    int originX = 0;
+    int originY = 0;
+    Grid2D<float> elevation;
+    Grid2D<TerrainType> terrain;
+    ElevationStats stats;
+};
+
+// Cells with terrain SAND or higher (the cells erosion spawns droplets on), in row-major order
+struct LandIndex
+{
+    std::vector<uint32_t> cells;    // y * width + x
+    std::vector<uint32_t> rowStart; // row y's cells are cells[rowStart[y]] .. cells[rowStart[y + 1] - 1]
 };
 
 class World
@@ -48,15 +60,40 @@ public:
         ARCHIPELAGO
     };
 
+    // REFERENCE evaluates one pixel at a time; BATCH runs the SIMD row kernel with output
+    // bit-identical to REFERENCE; BATCH_FAST additionally allows fused multiply-add.
+    // LATTICE hashes each octave's lattice once and interpolates rows from it (also bit-identical).
+    enum class NoiseKernel
+    {
+        REFERENCE,
+        BATCH,
+        BATCH_FAST,
+        LATTICE
+    };
+
 private:
     int width;
     int height;
     int tileSize;
     int seed;
+
+    // Placement of this map inside a larger virtual world (whole world by default).
+    // Noise and falloff are evaluated in world coordinates, so a region generates exactly
+    // the cells a full-size world would have there.
+    int originX = 0;
+    int originY = 0;
+    int worldWidth;
+    int worldHeight;
+
     IslandMode islandMode = IslandMode::SINGLE;
+    NoiseKernel noiseKernel = NoiseKernel::LATTICE;
+    ElevationStats generationStats;
+    LandIndex landIndex;
+    uint64_t dropletsDrawn = 0; // erosion droplets run on this world so far
+    bool verbose = true;
 
-    std::vector<std::vector<float>> elevationMap;
-    std::vector<std::vector<TerrainType>> terrainTypes;
+    Grid2D<float> elevationMap;
+    Grid2D<TerrainType> terrainTypes;
 
     // Noise parameters
     float frequency = 0.005f; // Lower frequency for larger features
@@ -82,26 +119,94 @@ private:
 
     // Helper functions
     float generateOctaveNoise(float x, float y);
-    float calculateFalloff(float x, float y);
-    float calculateArchipelagoFalloff(float x, float y);
+    void buildOctaveLattices(std::vector<Noise::OctaveLattice> &lattices, int x0, int y0, int w, int h);
+    void generateNoiseRow(int x0, int y, int count, float *row, const std::vector<Noise::OctaveLattice> &lattices);
+    void generateTile(int x0, int y0, int w, int h, float *elevation, TerrainType *terrain, int stride,
+                      const std::vector<Noise::OctaveLattice> &lattices, const Grid2D<float> *falloff,
+                      ElevationStats &noiseStats, ElevationStats &finalStats);
+    float calculateFalloff(float x, float y) const;
+    float calculateArchipelagoFalloff(float x, float y) const;
+    float calculateFalloffAt(int worldX, int worldY) const;
+    std::shared_ptr<const Grid2D<float>> getFalloffField() const;
     void applyFalloffMap();
+    void rebuildLandIndex();
+    void updateLandIndex(const GridRect &area);
     TerrainType getTerrainType(float elevation);
 
 public:
     World(int width, int height, int tileSize, int seed);
 
+    // Fused single-pass generation: noise, falloff, clamp, terrain classification and
+    // statistics per row band. Produces the same maps as generateNoiseMap() + assignTerrainTypes().
+    void generate();
+
+    // Fills rows [y0, y1) of this map (y0 a multiple of Parallel::ROW_BAND) into row-major buffers
+    // starting at row y0, and the per-band statistics for those rows into arrays indexed by band
+    // of the whole map. finishGeneration() then merges the statistics; together they make up generate().
+    void generateRows(int y0, int y1, float *elevation, TerrainType *terrain,
+                      ElevationStats *noiseStats, ElevationStats *finalStats);
+    void finishGeneration(const std::vector<ElevationStats> &noiseStats, const std::vector<ElevationStats> &finalStats);
+
+    // Puts this world's island falloff field in the FalloffCache ahead of generation
+    void prefetchFalloff() const;
+
+    // Generates only the cells [x0, x0 + w) x [y0, y0 + h) of the world, clipped to its bounds,
+    // without touching this map. Stitched regions are identical to generate() over the whole world.
+    WorldRegion generateRegion(int x0, int y0, int w, int h);
+
+    // Multi-pass reference implementation, kept for validation
     void generateNoiseMap();
     void assignTerrainTypes();
+    // Reclassifies only the cells in rect (and their land index entries), for local edits
+    void assignTerrainTypes(const GridRect &rect);
     void render(sf::RenderWindow &window);
     void renderHeightmap(sf::RenderWindow &window);
     void setIslandMode(IslandMode mode) { islandMode = mode; }
+    void setNoiseKernel(NoiseKernel kernel) { noiseKernel = kernel; }
+    void setVerbose(bool enabled) { verbose = enabled; }
+
+    // Makes this map the region [originX, originX + width) x [originY, originY + height)
+    // of a worldWidth x worldHeight world. Call before generating.
+    void setRegion(int originX, int originY, int worldWidth, int worldHeight);
+    bool coversWholeWorld() const { return originX == 0 && originY == 0 && width == worldWidth && height == worldHeight; }
 
     // Getters
     int getWidth() const { return width; }
     int getHeight() const { return height; }
+    int getSeed() const { return seed; }
+    int getOriginX() const { return originX; }
+    int getOriginY() const { return originY; }
+    int getWorldWidth() const { return worldWidth; }
+    int getWorldHeight() const { return worldHeight; }
+    const ElevationStats &getGenerationStats() const { return generationStats; }
+    // Elevation from which ElevationStats counts a cell as land: above the sand band. The land
+    // index also takes in sand (SAND and higher), so it holds more cells than that count.
+    float getLandThreshold() const { return thresholds.sand; }
+
+    // Rebuilt whenever terrain is classified (generation and assignTerrainTypes()), so it matches
+    // the elevation after every erosion pass
+    const LandIndex &getLandIndex() const { return landIndex; }
+
+    // Erosion droplet i of this world draws from the random stream keyed by (seed, i), so a
+    // world's erosion depends only on its seed and the erosion run on it since it was created.
+    // reserveDroplets() hands out the next count indices and returns the first.
+    uint64_t reserveDroplets(uint64_t count)
+    {
+        const uint64_t first = dropletsDrawn;
+        dropletsDrawn += count;
+        return first;
+    }
+    uint64_t getDropletsDrawn() const { return dropletsDrawn; }
+    void setDropletsDrawn(uint64_t count) { dropletsDrawn = count; }
     float getElevation(int x, int y) const;
     TerrainType getTerrain(int x, int y) const;
 
+    // Direct grid access for hot loops (no bounds checks)
+    const Grid2D<float> &getElevationMap() const { return elevationMap; }
+    Grid2D<float> &getElevationMap() { return elevationMap; }
+    const Grid2D<TerrainType> &getTerrainMap() const { return terrainTypes; }
+    Grid2D<TerrainType> &getTerrainMap() { return terrainTypes; }
+
     // Modifiers for erosion
     void modifyElevation(int x, int y, float delta);
     void normalizeElevation();
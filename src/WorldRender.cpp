@@ -0,0 +1,98 @@
+#include "World.h"
+#include "RenderColors.h"
+#include "Noise.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+void World::render(sf::RenderWindow &window)
+{
+    // Use vertex array for efficient rendering
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int index = (y * width + x) * 6;
+
+            // Define quad corners
+            float left = x * tileSize;
+            float top = y * tileSize;
+            float right = left + tileSize;
+            float bottom = top + tileSize;
+
+            // Get terrain color with slight variation for visual interest
+            sf::Color baseColor = TerrainColor::getColor(terrainTypes(x, y));
+
+            // Add subtle noise to the color for texture
+            int variation = (int)(Noise::hash(x, y, seed * 7) * 10) - 5;
+            sf::Color color(
+                std::max(0, std::min(255, baseColor.r + variation)),
+                std::max(0, std::min(255, baseColor.g + variation)),
+                std::max(0, std::min(255, baseColor.b + variation)));
+
+            // Create two triangles for the quad
+            // Triangle 1
+            vertices[index + 0].position = sf::Vector2f(left, top);
+            vertices[index + 1].position = sf::Vector2f(right, top);
+            vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+            // Triangle 2
+            vertices[index + 3].position = sf::Vector2f(right, top);
+            vertices[index + 4].position = sf::Vector2f(right, bottom);
+            vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+            // Set colors
+            for (int i = 0; i < 6; i++)
+            {
+                vertices[index + i].color = color;
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
+
+void World::renderHeightmap(sf::RenderWindow &window)
+{
+    // Render as grayscale heightmap
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles, width * height * 6);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int index = (y * width + x) * 6;
+
+            // Define quad corners
+            float left = x * tileSize;
+            float top = y * tileSize;
+            float right = left + tileSize;
+            float bottom = top + tileSize;
+
+            // Convert elevation to grayscale (0-255)
+            float elevation = elevationMap(x, y);
+            int gray = (int)((elevation + 1.0f) * 0.5f * 255.0f);
+            gray = std::max(0, std::min(255, gray));
+
+            sf::Color color(gray, gray, gray);
+
+            // Create two triangles for the quad
+            vertices[index + 0].position = sf::Vector2f(left, top);
+            vertices[index + 1].position = sf::Vector2f(right, top);
+            vertices[index + 2].position = sf::Vector2f(left, bottom);
+
+            vertices[index + 3].position = sf::Vector2f(right, top);
+            vertices[index + 4].position = sf::Vector2f(right, bottom);
+            vertices[index + 5].position = sf::Vector2f(left, bottom);
+
+            // Set colors
+            for (int i = 0; i < 6; i++)
+            {
+                vertices[index + i].color = color;
+            }
+        }
+    }
+
+    window.draw(vertices);
+}
\ No newline at end of file
@@ -3,23 +3,105 @@
 #include <chrono>
 #include <optional>
 #include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <memory>
 
 #include "World.h"
 #include "Erosion.h"
+#include "ErosionJob.h"
 #include "Climate.h"
 #include "Civilization.h"
+#include "Parallel.h"
+#include "FalloffCache.h"
+#include "ChunkedWorld.h"
+#include "ShardedGenerator.h"
 
-int main()
+int main(int argc, char *argv[])
 {
+    // World settings
+    int worldWidth = 300;
+    int worldHeight = 200;
+    const int tileSize = 4;
+
+    // Chunked mode streams the world in on demand instead of holding the whole map
+    bool chunked = false;
+    ChunkedWorld::Settings chunkSettings;
+
+    // Worker processes for whole-map generation (1 = generate in this process)
+    int processes = 1;
+
+    // Erosion engine used by the E key
+    ErosionSimulator::Engine erosionEngine = ErosionSimulator::Engine::DROPLETS;
+
+    // Command line options
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)
+        {
+            Parallel::setThreadCount(std::atoi(argv[++i]));
+        }
+        else if (arg == "--falloff-cache" && i + 1 < argc)
+        {
+            FalloffCache::setDiskCacheDirectory(argv[++i]);
+        }
+        else if (arg == "--processes" && i + 1 < argc)
+        {
+            processes = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--size" && i + 1 < argc)
+        {
+            std::string size = argv[++i];
+            size_t separator = size.find('x');
+            if (separator != std::string::npos)
+            {
+                worldWidth = std::atoi(size.substr(0, separator).c_str());
+                worldHeight = std::atoi(size.substr(separator + 1).c_str());
+            }
+        }
+        else if (arg == "--pipe-erosion")
+        {
+            erosionEngine = ErosionSimulator::Engine::PIPE;
+        }
+        else if (arg == "--chunked")
+        {
+            chunked = true;
+        }
+        else if (arg == "--chunk-size" && i + 1 < argc)
+        {
+            chunkSettings.chunkSize = std::atoi(argv[++i]);
+        }
+        else if (arg == "--max-chunks" && i + 1 < argc)
+        {
+            chunkSettings.maxChunks = std::atoi(argv[++i]);
+        }
+        else if (arg == "--chunk-erosion" && i + 1 < argc)
+        {
+            chunkSettings.dropletsPerChunk = std::atoi(argv[++i]);
+        }
+        else if (arg == "--chunk-climate")
+        {
+            chunkSettings.climate = true;
+        }
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [--threads N] [--falloff-cache DIR] [--processes N] [--size WxH] [--pipe-erosion]"
+                      << " [--chunked [--chunk-size N] [--max-chunks N] [--chunk-erosion DROPLETS] [--chunk-climate]]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (worldWidth < 2 || worldHeight < 2)
+    {
+        std::cout << "World size must be at least 2x2" << std::endl;
+        return 1;
+    }
+
     // Window settings
     const unsigned int windowWidth = 1200;
     const unsigned int windowHeight = 800;
 
-    // World settings
-    const int worldWidth = 300;
-    const int worldHeight = 200;
-    const int tileSize = 4;
-
     // Create window
     sf::RenderWindow window(sf::VideoMode({windowWidth, windowHeight}), "Genesis Engine - Phase 2: Civilization");
     window.setFramerateLimit(60);
@@ -28,10 +110,14 @@ int main()
     auto now = std::chrono::system_clock::now();
     auto seed = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
 
-    World world(worldWidth, worldHeight, tileSize, seed);
+    // In chunked mode the full-map systems stay empty and are never generated
+    const int mapWidth = chunked ? 0 : worldWidth;
+    const int mapHeight = chunked ? 0 : worldHeight;
+    World world(mapWidth, mapHeight, tileSize, seed);
+    std::unique_ptr<ChunkedWorld> chunkedWorld;
 
     // Print controls to the console
-    std::cout << "Generating world with seed: " << seed << std::endl;
+    std::cout << "Generating world with seed: " << seed << " on " << Parallel::getThreadCount() << " threads" << std::endl;
     std::cout << "\nControls:" << std::endl;
     std::cout << "  Movement:" << std::endl;
     std::cout << "    WASD/Arrow Keys - Move camera" << std::endl;
@@ -40,7 +126,9 @@ int main()
     std::cout << "\n  World Generation:" << std::endl;
     std::cout << "    R - Regenerate world (single island)" << std::endl;
     std::cout << "    T - Generate archipelago (multiple islands)" << std::endl;
-    std::cout << "    E - Apply erosion simulation" << std::endl;
+    std::cout << "    E - Apply erosion simulation (press again to stop)" << std::endl;
+    std::cout << "    B - Erode the area under the mouse" << std::endl;
+    std::cout << "    G - Apply thermal erosion (relax steep slopes)" << std::endl;
     std::cout << "    C - Generate climate and biomes" << std::endl;
     std::cout << "    V - Initialize civilization" << std::endl;
     std::cout << "    N - Next turn (simulate civilization)" << std::endl;
@@ -56,17 +144,32 @@ int main()
     std::cout << "\nRecommended sequence: R -> E -> C -> V -> N" << std::endl;
 
     // Generate initial world
-    world.generateNoiseMap();
-    world.assignTerrainTypes();
-    std::cout << "World generation complete!" << std::endl;
+    if (chunked)
+    {
+        chunkedWorld = std::make_unique<ChunkedWorld>(worldWidth, worldHeight, tileSize, seed, chunkSettings);
+        std::cout << "Streaming a " << worldWidth << "x" << worldHeight << " world in "
+                  << chunkSettings.chunkSize << "x" << chunkSettings.chunkSize << " chunks" << std::endl;
+    }
+    else
+    {
+        ShardedGenerator::generate(world, processes);
+        std::cout << "World generation complete!" << std::endl;
+    }
 
     // Create simulation systems and state flags
-    ErosionSimulator erosion(seed);
-    ClimateSystem climate(worldWidth, worldHeight);
-    CivilizationSystem civilization(worldWidth, worldHeight);
+    ErosionSimulator erosion;
+    erosion.setDropletKernel(ErosionSimulator::DropletKernel::BATCHED);
+    erosion.setEngine(erosionEngine);
+    ClimateSystem climate(mapWidth, mapHeight);
+    CivilizationSystem civilization(mapWidth, mapHeight);
     bool climateGenerated = false;
     bool civilizationActive = false;
 
+    // Droplet erosion runs a slice per frame so the terrain can be watched as it forms
+    const double erosionFrameBudgetMs = 12.0;
+    std::unique_ptr<ErosionJob> erosionJob;
+    int erosionReportedTenths = 0;
+
     // Create view for camera control
     sf::View view;
     view.setSize(sf::Vector2f(windowWidth, windowHeight));
@@ -112,37 +215,92 @@ int main()
                 if (keyEvent->code == sf::Keyboard::Key::R || keyEvent->code == sf::Keyboard::Key::T)
                 {
                     seed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-                    world = World(worldWidth, worldHeight, tileSize, seed);
+                    world = World(mapWidth, mapHeight, tileSize, seed);
 
                     if (keyEvent->code == sf::Keyboard::Key::R)
                     {
                         world.setIslandMode(World::IslandMode::SINGLE);
+                        chunkSettings.islandMode = World::IslandMode::SINGLE;
                         std::cout << "Regenerating world with seed: " << seed << " (Single Island)" << std::endl;
                     }
                     else
                     {
                         world.setIslandMode(World::IslandMode::ARCHIPELAGO);
+                        chunkSettings.islandMode = World::IslandMode::ARCHIPELAGO;
                         std::cout << "Regenerating world with seed: " << seed << " (Archipelago)" << std::endl;
                     }
 
-                    world.generateNoiseMap();
-                    world.assignTerrainTypes();
+                    if (chunked)
+                    {
+                        chunkedWorld = std::make_unique<ChunkedWorld>(worldWidth, worldHeight, tileSize, seed, chunkSettings);
+                    }
+                    else
+                    {
+                        ShardedGenerator::generate(world, processes);
+                    }
 
                     // Reset dependent states
+                    erosionJob.reset();
                     climateGenerated = false;
                     civilizationActive = false;
                     viewMode = ViewMode::TERRAIN;
                     std::cout << "World regeneration complete! Climate and civilization have been reset." << std::endl;
                 }
+                // Whole-map simulations need the full map in memory
+                else if (chunked && (keyEvent->code == sf::Keyboard::Key::E || keyEvent->code == sf::Keyboard::Key::B ||
+                                     keyEvent->code == sf::Keyboard::Key::G ||
+                                     keyEvent->code == sf::Keyboard::Key::C || keyEvent->code == sf::Keyboard::Key::V ||
+                                     keyEvent->code == sf::Keyboard::Key::N))
+                {
+                    std::cout << "Not available in chunked mode (use --chunk-erosion / --chunk-climate instead)" << std::endl;
+                }
                 // Apply erosion
                 else if (keyEvent->code == sf::Keyboard::Key::E)
                 {
-                    std::cout << "Applying hydraulic erosion..." << std::endl;
-                    erosion.getParameters().erosion = 0.5f;
-                    erosion.getParameters().capacity = 8.0f;
-                    erosion.getParameters().maxLifetime = 50;
-                    erosion.erode(world, 200000);
-                    std::cout << "Erosion complete! Rivers and valleys carved." << std::endl;
+                    if (erosionJob)
+                    {
+                        erosionJob->cancel();
+                        std::cout << "Erosion cancelled at " << (int)(erosionJob->getProgress() * 100) << "%" << std::endl;
+                        erosionJob.reset();
+                    }
+                    else if (erosion.getEngine() == ErosionSimulator::Engine::PIPE)
+                    {
+                        std::cout << "Applying hydraulic erosion..." << std::endl;
+                        erosion.erode(world);
+                        std::cout << "Erosion complete! Rivers and valleys carved." << std::endl;
+                    }
+                    else
+                    {
+                        std::cout << "Applying hydraulic erosion (press E again to stop)..." << std::endl;
+                        erosion.getParameters().erosion = 0.5f;
+                        erosion.getParameters().capacity = 8.0f;
+                        erosion.getParameters().maxLifetime = 50;
+                        erosionJob = std::make_unique<ErosionJob>(erosion, world, 200000);
+                        erosionReportedTenths = 0;
+                    }
+                }
+                // Erode a patch around the cursor; only the cells it changed are reclassified
+                else if (keyEvent->code == sf::Keyboard::Key::B)
+                {
+                    const sf::Vector2f mouse = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+                    const int centerX = (int)(mouse.x / tileSize);
+                    const int centerY = (int)(mouse.y / tileSize);
+                    const int radius = 20;
+                    GridRect dirty = erosion.erodeRegion(world, GridRect(centerX - radius, centerY - radius, centerX + radius, centerY + radius), 5000);
+                    if (climateGenerated)
+                    {
+                        climate.updateRegion(world, dirty);
+                    }
+                    if (!dirty.isEmpty())
+                    {
+                        std::cout << "Local erosion changed " << dirty.getWidth() << "x" << dirty.getHeight() << " cells" << std::endl;
+                    }
+                }
+                // Apply thermal erosion
+                else if (keyEvent->code == sf::Keyboard::Key::G)
+                {
+                    erosion.erodeThermal(world);
+                    std::cout << "Thermal erosion complete! Steep slopes relaxed." << std::endl;
                 }
                 // Generate climate
                 else if (keyEvent->code == sf::Keyboard::Key::C)
@@ -246,6 +404,23 @@ int main()
             }
         }
 
+        // Advance running erosion by one slice
+        if (erosionJob)
+        {
+            erosionJob->step(erosionFrameBudgetMs);
+            const int tenths = (int)(erosionJob->getProgress() * 10);
+            if (erosionJob->isFinished())
+            {
+                std::cout << "Erosion complete! Rivers and valleys carved." << std::endl;
+                erosionJob.reset();
+            }
+            else if (tenths > erosionReportedTenths)
+            {
+                erosionReportedTenths = tenths;
+                std::cout << "Erosion progress: " << tenths * 10 << "%" << std::endl;
+            }
+        }
+
         // Camera movement
         sf::Vector2f movement(0.0f, 0.0f);
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up))
@@ -289,6 +464,19 @@ int main()
         // Render everything
         window.clear(sf::Color::Black);
 
+        if (chunked)
+        {
+            if (viewMode == ViewMode::HEIGHTMAP)
+                chunkedWorld->renderHeightmap(window);
+            else if (viewMode == ViewMode::BIOMES)
+                chunkedWorld->renderBiomes(window);
+            else
+                chunkedWorld->render(window);
+
+            window.display();
+            continue;
+        }
+
         switch (viewMode)
         {
         case ViewMode::TERRAIN: